@@ -2,6 +2,10 @@
 #define HARDWARE_CAN_H
 
 #include "can_frame.h"
+#include "can_subscriber.h"
+#include "can_shaper.h"
+#include "can_rtr_responder.h"
+#include "can_task_control.h"
 #include "esp32_c3_objects/thread.h"
 #include "esp32_c3_objects/semaphore.h"
 #include "esp32_c3_objects/callback.h"
@@ -16,6 +20,7 @@ namespace canbus
     constexpr uint8_t CAN_RX_BUFFER_SIZE = 64;        ///< Размер буфера приема
     constexpr uint16_t CAN_RECEIVE_MS_TO_TICKS = 100; ///< Таймаут приема (мс)
     constexpr uint16_t CAN_SEND_MS_TO_TICKS = 4;      ///< Таймаут отправки (мс)
+    constexpr uint16_t CAN_WATCHDOG_MS = 200;         ///< Период проверки состояния (мс)
 
     /**
      * @brief Скорости CAN-шины
@@ -42,8 +47,11 @@ namespace canbus
         uint32_t id = 0;            ///< Идентификатор
         uint32_t mask = 0;          ///< Маска
         int16_t callbackIndex = -1; ///< Индекс callback-функции
+        int8_t e2eProfile = -1;     ///< Индекс E2E-профиля проверки
     };
 
+    class CanTimeSync;
+
     /**
      * @brief Класс для работы с CAN-интерфейсом
      */
@@ -75,6 +83,8 @@ namespace canbus
 
         /**
          * @brief Деинициализация CAN-интерфейса
+         * @note Задачи приема и watchdog останавливаются между итерациями, когда не удерживают
+         * семафоры и кадры пула. Не вызывать из callback приема
          */
         void end();
 
@@ -97,6 +107,13 @@ namespace canbus
          */
         void setSpeed(CanSpeed speed);
 
+        /**
+         * @brief Получить скорость шины в бит/с
+         * @param speed Скорость передачи
+         * @return Скорость (бит/с)
+         */
+        static uint32_t getBitrate(CanSpeed speed);
+
         /**
          * @brief Установка фильтра
          * @param index Индекс фильтра
@@ -130,12 +147,129 @@ namespace canbus
          */
         void clearFilters();
 
+        /**
+         * @brief Установка E2E-профиля
+         * @param index Индекс профиля
+         * @param profile Параметры профиля
+         * @return true если профиль установлен, false при совпадении байтов CRC и счетчика,
+         * позиции вне кадра или сдвиге счетчика, отличном от 0 и 4
+         */
+        bool setE2EProfile(uint8_t index, const CanE2EProfile& profile);
+
+        /**
+         * @brief Получить E2E-профиль
+         * @param index Индекс профиля
+         * @return Параметры профиля
+         */
+        CanE2EProfile getE2EProfile(int8_t index) const;
+
+        /**
+         * @brief Привязка E2E-профиля к фильтру для проверки принятых кадров
+         * @param filterIndex Индекс фильтра
+         * @param profileIndex Индекс профиля (-1 - отключить проверку)
+         * @return true если профиль привязан
+         */
+        bool setFilterE2E(uint8_t filterIndex, int8_t profileIndex);
+
+        /**
+         * @brief Получить состояние и статистику E2E фильтра
+         * @param filterIndex Индекс фильтра
+         * @return Состояние проверки E2E
+         */
+        CanE2EState getE2EState(int16_t filterIndex) const;
+
         /**
          * @brief Отправить CAN-кадр
          * @param frame CAN-кадр для отправки
          * @return true если отправка прошла успешно
          */
-        bool send(CanFrame& frame) const;
+        bool send(CanFrame& frame);
+
+        /**
+         * @brief Отправить кадр при пустой очереди передачи драйвера
+         * @param frame CAN-кадр
+         * @param timeout Ожидание передачи ранее поставленных кадров (мс)
+         * @return true если кадр поставлен в пустую очередь первым
+         * @note Очередь ожидается без семафора. Семафор захватывается только на проверку очереди,
+         * сброс накопленных событий драйвера и постановку кадра без ожидания, поэтому первое
+         * TWAI_ALERT_TX_SUCCESS после успешного вызова относится к этому кадру. Если в это время
+         * кадр поставила задача приема (ответ RTR), возвращается false. Кадр не ограничивается,
+         * но учитывается в бюджете шины
+         */
+        bool sendWhenIdle(const CanFrame& frame, unsigned long timeout);
+
+        /**
+         * @brief Установка правила ограничения передачи
+         * @param index Индекс правила
+         * @param rule Параметры правила (token bucket на ID или диапазон ID)
+         */
+        void setShaperRule(uint8_t index, const CanShaperRule& rule);
+
+        /**
+         * @brief Очистить все правила ограничения передачи
+         */
+        void clearShaperRules();
+
+        /**
+         * @brief Установка бюджета загрузки шины
+         * @param percent Бюджет (%), 100 - без ограничения
+         * @param policy Поведение при превышении для кадров без правила
+         */
+        void setBusLoadBudget(uint8_t percent, CanShapePolicy policy = CanShapePolicy::DELAY);
+
+        /**
+         * @brief Получить статистику ограничителя и использование бюджета
+         * @return Статистика ограничителя
+         */
+        CanShaperStats getShaperStats() const;
+
+        /**
+         * @brief Установка автоматического ответа на удаленный запрос
+         * @param frame Кадр ответа (id, формат, данные, E2E-профиль)
+         * @return Индекс записи или -1 при ошибке
+         */
+        int setRtrResponse(const CanFrame& frame);
+
+        /**
+         * @brief Обновление данных автоматического ответа
+         * @param id Идентификатор
+         * @param extended Флаг расширенного формата
+         * @param data Данные
+         * @param length Длина данных (0-8)
+         * @return true если запись найдена
+         */
+        bool updateRtrResponse(uint32_t id, bool extended, const uint8_t* data, uint8_t length);
+
+        /**
+         * @brief Удаление автоматического ответа
+         * @param id Идентификатор
+         * @param extended Флаг расширенного формата
+         */
+        void removeRtrResponse(uint32_t id, bool extended);
+
+        /**
+         * @brief Очистить таблицу автоматических ответов
+         */
+        void clearRtrResponses();
+
+        /**
+         * @brief Получить статистику автоматических ответов
+         * @return Статистика ответов и задержка постановки ответа в очередь драйвера
+         */
+        CanRtrStats getRtrStats() const;
+
+        /**
+         * @brief Подключение синхронизации времени (вызывается CanTimeSync)
+         * @param timeSync Синхронизация времени или nullptr
+         * @note После возврата прежний объект не используется задачей приема и getTime()
+         */
+        void setTimeSync(CanTimeSync* timeSync);
+
+        /**
+         * @brief Текущее время в шкале меток принятых кадров
+         * @return Время (мкс), общее при подключенной синхронизации, иначе локальное
+         */
+        int64_t getTime() const;
 
         /**
          * @brief Получить CAN-кадр из буфера
@@ -144,6 +278,27 @@ namespace canbus
          */
         bool receive(CanFrame& frame) const;
 
+        /**
+         * @brief Подключить подписчика на принятые кадры
+         * @param subscriber Подписчик
+         * @return true если подписчик подключен
+         * @note Подписчик резервирует в пуле кадры по глубине очереди, подключение отклоняется,
+         * если резервов всех подписчиков не хватает пула
+         */
+        bool subscribe(CanSubscriber* subscriber);
+
+        /**
+         * @brief Отключить подписчика
+         * @param subscriber Подписчик
+         */
+        void unsubscribe(CanSubscriber* subscriber);
+
+        /**
+         * @brief Количество кадров, не доставленных подписчикам из-за исчерпания пула
+         * @return Счетчик переполнений пула (при соблюдении резервов остается нулевым)
+         */
+        uint32_t getPoolOverflows() const;
+
         /**
          * @brief Обработчик ответа
          * @param value Указатель на данные
@@ -164,14 +319,16 @@ namespace canbus
 
         /**
          * @brief Обработчик watchdog-таймера
+         * @return Пауза до следующего вызова (мс): меньше CAN_WATCHDOG_MS, если отложенному
+         * кадру ограничителя ресурс появится раньше
          */
-        void handleWatchdog();
+        uint32_t handleWatchdog();
 
         /**
          * @brief Обработчик приема сообщений
          * @return true если интерфейс готов к работе
          */
-        bool handleReceive() const;
+        bool handleReceive();
 
     private:
         /**
@@ -188,17 +345,80 @@ namespace canbus
         /**
          * @brief Обработка входящего сообщения
          * @param message Входящее сообщение
+         * @param rxTime Время приема (мкс)
+         */
+        void processFrame(const twai_message_t& message, int64_t rxTime);
+
+        /**
+         * @brief Ответ на удаленный запрос из таблицы без участия задач приложения
+         * @param message Удаленный запрос
+         * @param rxTime Время приема запроса (мкс)
+         * @return true если запрос обслужен
+         */
+        bool respondRemote(const twai_message_t& message, int64_t rxTime);
+
+        /**
+         * @brief Передача кадра драйверу (с E2E-защитой)
+         * @param frame CAN-кадр
+         * @param timeout Таймаут постановки в очередь (тики)
+         * @return true если кадр поставлен в очередь передачи
+         * @note Вызывается и задачей приема без семафора Can: значение счетчика E2E резервируется
+         * в критической секции и возвращается при ошибке, если его не занял другой кадр
+         */
+        bool transmit(const CanFrame& frame, TickType_t timeout);
+
+        /**
+         * @brief Возврат неиспользованного значения счетчика E2E
+         * @param profile Индекс профиля
+         * @param counter Зарезервированное значение
+         */
+        void releaseE2ECounter(int8_t profile, uint8_t counter);
+
+        /**
+         * @brief Учет кадра, отправленного в обход ограничителя
+         * @param frame CAN-кадр
+         */
+        void accountShaper(const CanFrame& frame);
+
+        /**
+         * @brief Передача отложенных кадров ограничителя
+         */
+        void transmitPending();
+
+        /**
+         * @brief Рассылка кадра подписчикам
+         * @param frame Принятый кадр
          */
-        void processFrame(const twai_message_t& message) const;
+        void publishFrame(const CanFrame& frame);
 
         /// Поток для мониторинга состояния
         esp32_c3_objects::Thread mWatchdogThread;
         /// Поток для приема сообщений
         esp32_c3_objects::Thread mReceiveThread;
+        /// Управление остановкой задачи watchdog
+        CanTaskControl mWatchdogControl;
+        /// Управление остановкой задачи приема
+        CanTaskControl mReceiveControl;
         /// Callback-механизм
         esp32_c3_objects::Callback* mCallback = nullptr;
         /// Семафор для синхронизации
         esp32_c3_objects::Semaphore mSemaphore;
+        /// Семафор списка подписчиков
+        esp32_c3_objects::Semaphore mSubscriberSemaphore;
+        /// Семафор подключенной синхронизации времени
+        esp32_c3_objects::Semaphore mTimeSyncSemaphore;
+        /// Критическая секция ограничителя и счетчиков E2E (не блокирует задачу приема)
+        mutable portMUX_TYPE mTxLock = portMUX_INITIALIZER_UNLOCKED;
+        /// Количество попыток постановки кадров в очередь драйвера
+        std::atomic<uint32_t> mTxAttempts{0};
+        /// Подписчики на принятые кадры
+        CanSubscriber* mSubscribers[CAN_NUM_SUBSCRIBER] = {};
+        /// Пул разделяемых кадров
+        CanFramePool mFramePool;
+        /// Кадры пула, зарезервированные подписчиками
+        uint16_t mPoolReserved = 0;
+        /// Счетчик переполнений пула
+        uint32_t mPoolOverflows = 0;
 
         /// Текущая скорость
         CanSpeed mSpeed = CanSpeed::SPEED_125KBIT;
@@ -208,6 +428,18 @@ namespace canbus
         twai_status_info_t mStatusInfo = {};
         /// Массив фильтров
         CanFilter mFilters[CAN_NUM_FILTER];
+        /// Ограничитель передачи (под mTxLock)
+        CanShaper mShaper;
+        /// Синхронизация времени
+        CanTimeSync* mTimeSync = nullptr;
+        /// Таблица ответов на удаленные запросы
+        CanRtrResponder mRtrResponder;
+        /// Массив E2E-профилей
+        CanE2EProfile mE2EProfiles[CAN_NUM_E2E_PROFILE];
+        /// Счетчики E2E для следующей отправки по профилям (под mTxLock)
+        uint8_t mE2ECounters[CAN_NUM_E2E_PROFILE] = {};
+        /// Состояния проверки E2E по фильтрам
+        CanE2EState mE2EStates[CAN_NUM_FILTER];
 
         /// Конфигурация драйвера
         twai_general_config_t mDriverConfig = {};
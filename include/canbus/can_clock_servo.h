@@ -0,0 +1,95 @@
+#ifndef HARDWARE_CAN_CLOCK_SERVO_H
+#define HARDWARE_CAN_CLOCK_SERVO_H
+
+#include <cstdint>
+
+namespace canbus
+{
+    /**
+     * @brief Константы фильтра синхронизации часов
+     */
+    constexpr int64_t CAN_SERVO_STEP_THRESHOLD_US = 1000; ///< Порог скачка сверх возможного дрейфа за интервал (мкс)
+    constexpr int32_t CAN_SERVO_MAX_DRIFT_PPB = 500000;   ///< Ограничение коррекции частоты (ppb)
+    constexpr int32_t CAN_SERVO_MAX_SLEW_PPB = 1000000;   ///< Ограничение скорости коррекции фазы (ppb)
+    constexpr uint8_t CAN_SERVO_PHASE_SHIFT = 1;          ///< Коэффициент коррекции фазы (1/2^n)
+    constexpr uint8_t CAN_SERVO_DRIFT_SHIFT = 2;          ///< Коэффициент коррекции дрейфа (1/2^n)
+    constexpr uint8_t CAN_SERVO_LOCK_SAMPLES = 4;         ///< Количество отсчетов до захвата
+
+    /**
+     * @brief Фильтр оценки смещения и дрейфа локальных часов относительно ведущего узла
+     * @note Не зависит от оборудования, время передается в микросекундах. Частота оценивается
+     * по двум первым отсчетам. После этого общая шкала непрерывна и монотонна: ошибка фазы
+     * отрабатывается изменением скорости на следующем интервале (не более CAN_SERVO_MAX_SLEW_PPB).
+     * Скачок выполняется только при захвате и если ошибка больше возможной при предельном дрейфе
+     * за интервал (скачок времени ведущего узла), оценка частоты при этом сохраняется.
+     */
+    class CanClockServo
+    {
+    public:
+        /**
+         * @brief Сброс состояния
+         */
+        void reset();
+
+        /**
+         * @brief Добавление пары отметок времени
+         * @param masterTime Время ведущего узла (мкс)
+         * @param localTime Локальное время того же события (мкс)
+         */
+        void sample(int64_t masterTime, int64_t localTime);
+
+        /**
+         * @brief Перевод локального времени в общую шкалу
+         * @param localTime Локальное время (мкс)
+         * @return Время в общей шкале (мкс)
+         */
+        [[nodiscard]] int64_t toShared(int64_t localTime) const;
+
+        /**
+         * @brief Проверка захвата
+         * @return true если оценка смещения и дрейфа установилась
+         */
+        [[nodiscard]] bool isLocked() const;
+
+        /**
+         * @brief Ошибка последнего отсчета относительно прогноза
+         * @return Ошибка (мкс)
+         */
+        [[nodiscard]] int64_t getLastError() const;
+
+        /**
+         * @brief Коррекция частоты локальных часов (обратна их дрейфу)
+         * @return Коррекция (ppb)
+         */
+        [[nodiscard]] int32_t getDrift() const;
+
+        /**
+         * @brief Порог скачкообразной коррекции для интервала между отсчетами
+         * @param interval Интервал (мкс)
+         * @return Порог ошибки (мкс)
+         */
+        static int64_t stepThreshold(int64_t interval);
+
+    private:
+        /// Наличие опорной точки
+        bool mHasAnchor = false;
+        /// Количество отсчетов после последнего скачка
+        uint8_t mSamples = 0;
+        /// Локальное время опорной точки (мкс)
+        int64_t mAnchorLocal = 0;
+        /// Общее время опорной точки (мкс)
+        int64_t mAnchorShared = 0;
+        /// Время ведущего узла последнего отсчета (мкс)
+        int64_t mLastMaster = 0;
+        /// Коррекция частоты (ppb)
+        int32_t mDriftPpb = 0;
+        /// Дополнительная скорость отработки ошибки фазы (ppb)
+        int32_t mSlewPpb = 0;
+        /// Длительность отработки ошибки фазы от опорной точки (мкс локального времени)
+        int64_t mSlewDuration = 0;
+        /// Ошибка последнего отсчета (мкс)
+        int64_t mLastError = 0;
+    };
+} // namespace hardware
+
+#endif // HARDWARE_CAN_CLOCK_SERVO_H
@@ -0,0 +1,118 @@
+#ifndef HARDWARE_CAN_E2E_H
+#define HARDWARE_CAN_E2E_H
+
+#include <cstdint>
+
+namespace canbus
+{
+    /**
+     * @brief Константы E2E-защиты
+     */
+    constexpr uint8_t CAN_NUM_E2E_PROFILE = 8;     ///< Количество E2E-профилей
+    constexpr uint8_t CAN_E2E_COUNTER_MASK = 0x0F; ///< Маска 4-битного счетчика
+    constexpr uint8_t CAN_E2E_MAX_LENGTH = 8;      ///< Максимальная длина защищаемых данных (байт)
+
+    /**
+     * @brief Полином CRC8
+     */
+    enum class CanE2ECrc : uint8_t
+    {
+        SAE_J1850, ///< SAE J1850 (полином 0x1D)
+        CRC8H2F    ///< AUTOSAR CRC8H2F (полином 0x2F)
+    };
+
+    /**
+     * @brief Результат проверки E2E
+     */
+    enum class CanE2EStatus : uint8_t
+    {
+        NONE,          ///< Защита не применялась
+        OK,            ///< Кадр корректен
+        OK_SOME_LOST,  ///< Кадр корректен, есть пропуск счетчика
+        WRONG_CRC,     ///< Неверная контрольная сумма
+        REPEATED,      ///< Повтор счетчика
+        WRONG_SEQUENCE ///< Недопустимый скачок счетчика
+    };
+
+    /**
+     * @brief Профиль E2E-защиты
+     */
+    struct CanE2EProfile
+    {
+        bool configured = false;              ///< Флаг настройки профиля
+        CanE2ECrc crc = CanE2ECrc::SAE_J1850; ///< Полином CRC8
+        uint16_t dataId = 0;                  ///< Идентификатор данных (входит в CRC)
+        uint8_t crcByte = 0;                  ///< Позиция байта CRC
+        uint8_t counterByte = 1;              ///< Позиция байта счетчика
+        uint8_t counterShift = 0;             ///< Сдвиг счетчика в байте (0 или 4)
+        uint8_t maxDeltaCounter = 1;          ///< Допустимый шаг счетчика
+        bool dropInvalid = true;              ///< Отбрасывать некорректные кадры
+    };
+
+    /**
+     * @brief Состояние и статистика проверки E2E на приеме
+     */
+    struct CanE2EState
+    {
+        bool initialized = false;    ///< Получен хотя бы один корректный кадр
+        uint8_t lastCounter = 0;     ///< Последнее значение счетчика
+        uint32_t okCount = 0;        ///< Количество корректных кадров
+        uint32_t crcErrors = 0;      ///< Количество ошибок CRC
+        uint32_t repeated = 0;       ///< Количество повторов счетчика
+        uint32_t sequenceErrors = 0; ///< Количество недопустимых скачков счетчика
+        uint32_t lostFrames = 0;     ///< Суммарный пропуск кадров по счетчику
+    };
+
+    /**
+     * @brief Табличный расчет CRC8 и счетчика E2E
+     */
+    class CanE2E
+    {
+    public:
+        /**
+         * @brief Проверка параметров профиля
+         * @param profile E2E-профиль
+         * @return true если байты CRC и счетчика различны и лежат в кадре, а сдвиг счетчика 0 или 4
+         */
+        static bool isValid(const CanE2EProfile& profile);
+
+        /**
+         * @brief Расчет CRC8 по защищаемым данным
+         * @param profile E2E-профиль
+         * @param data Данные кадра
+         * @param length Длина данных
+         * @return Значение CRC8 (байт CRC исключается из расчета)
+         */
+        static uint8_t calculateCrc(const CanE2EProfile& profile, const uint8_t* data, uint8_t length);
+
+        /**
+         * @brief Запись счетчика и CRC в данные кадра
+         * @param profile E2E-профиль
+         * @param data Данные кадра
+         * @param length Длина данных
+         * @param counter Значение счетчика
+         * @return true если профиль применим к кадру
+         */
+        static bool protect(const CanE2EProfile& profile, uint8_t* data, uint8_t length, uint8_t counter);
+
+        /**
+         * @brief Проверка счетчика и CRC принятого кадра
+         * @param profile E2E-профиль
+         * @param data Данные кадра
+         * @param length Длина данных
+         * @param state Состояние приема (обновляется)
+         * @return Результат проверки
+         */
+        static CanE2EStatus check(const CanE2EProfile& profile, const uint8_t* data, uint8_t length,
+                                  CanE2EState& state);
+
+        /**
+         * @brief Проверка статуса на ошибку
+         * @param status Результат проверки
+         * @return true если кадр не прошел проверку
+         */
+        static bool isError(CanE2EStatus status);
+    };
+} // namespace hardware
+
+#endif // HARDWARE_CAN_E2E_H
@@ -2,6 +2,7 @@
 #define HARDWARE_CAN_FRAME_H
 
 #include <Arduino.h>
+#include "can_e2e.h"
 
 namespace canbus
 {
@@ -105,6 +106,9 @@ namespace canbus
         int8_t filterIndex = -1;             ///< Индекс фильтра
         uint16_t frequency = CAN_FRAME_FREQ; ///< Частота отправки (мс)
         unsigned long nextSendTime = 0;      ///< Время следующей отправки (мс)
+        int8_t e2eProfile = -1;              ///< Индекс E2E-профиля для отправки
+        CanE2EStatus e2eStatus = CanE2EStatus::NONE; ///< Результат проверки E2E при приеме
+        int64_t timestamp = 0;               ///< Время приема в общей шкале (мкс)
 
         /**
          * @brief Конструктор
@@ -0,0 +1,138 @@
+#ifndef HARDWARE_CAN_FRAME_POOL_H
+#define HARDWARE_CAN_FRAME_POOL_H
+
+#include "can_frame.h"
+#include <atomic>
+
+namespace canbus
+{
+    /**
+     * @brief Константы пула кадров
+     */
+    constexpr uint8_t CAN_FRAME_POOL_SIZE = 64; ///< Количество кадров в пуле (резервируется подписчиками)
+
+    class CanSubscriber;
+
+    /**
+     * @brief Кадр пула со счетчиком ссылок
+     */
+    struct CanPoolFrame
+    {
+        CanFrame frame;               ///< Данные кадра
+        std::atomic<uint8_t> refs{0}; ///< Счетчик ссылок (0 - кадр свободен)
+    };
+
+    /**
+     * @brief Пул разделяемых кадров
+     * @note Захват выполняется одной задачей приема, освобождение - из любых задач
+     */
+    class CanFramePool
+    {
+    public:
+        CanFramePool() = default;
+
+        // Запрет копирования
+        CanFramePool(const CanFramePool&) = delete;
+        CanFramePool& operator=(const CanFramePool&) = delete;
+
+        /**
+         * @brief Захват свободного кадра
+         * @return Кадр со счетчиком ссылок 1 или nullptr при исчерпании пула
+         */
+        CanPoolFrame* acquire();
+
+        /**
+         * @brief Количество свободных кадров
+         * @return Число кадров со счетчиком ссылок 0
+         */
+        [[nodiscard]] uint8_t available() const;
+
+        /**
+         * @brief Увеличение счетчика ссылок
+         * @param frame Кадр пула
+         */
+        static void retain(CanPoolFrame* frame);
+
+        /**
+         * @brief Уменьшение счетчика ссылок (кадр возвращается в пул при 0)
+         * @param frame Кадр пула
+         */
+        static void release(CanPoolFrame* frame);
+
+    private:
+        /// Кадры пула
+        CanPoolFrame mFrames[CAN_FRAME_POOL_SIZE];
+    };
+
+    /**
+     * @brief Ссылка на разделяемый кадр пула
+     * @note Ссылка освобождается автоматически при разрушении или reset() и возвращает
+     * резерв подписчику, от которого получена. Освобождайте ссылки до разрушения подписчика.
+     */
+    class CanFrameRef
+    {
+    public:
+        CanFrameRef() = default;
+
+        /**
+         * @brief Деструктор
+         */
+        ~CanFrameRef();
+
+        // Запрет копирования
+        CanFrameRef(const CanFrameRef&) = delete;
+        CanFrameRef& operator=(const CanFrameRef&) = delete;
+
+        /**
+         * @brief Конструктор перемещения
+         */
+        CanFrameRef(CanFrameRef&& other) noexcept;
+
+        /**
+         * @brief Оператор перемещения
+         */
+        CanFrameRef& operator=(CanFrameRef&& other) noexcept;
+
+        /**
+         * @brief Освобождение ссылки
+         */
+        void reset();
+
+        /**
+         * @brief Получить кадр
+         * @return Указатель на кадр или nullptr
+         */
+        [[nodiscard]] const CanFrame* get() const;
+
+        /**
+         * @brief Доступ к полям кадра
+         */
+        const CanFrame* operator->() const { return get(); }
+
+        /**
+         * @brief Проверка наличия кадра
+         */
+        explicit operator bool() const { return mFrame != nullptr; }
+
+    protected:
+        /**
+         * @brief Дружественный класс подписчика
+         */
+        friend class CanSubscriber;
+
+        /**
+         * @brief Привязка к кадру пула (ссылка передается во владение)
+         * @param frame Кадр пула
+         * @param owner Подписчик, резерв которого занимает ссылка
+         */
+        void attach(CanPoolFrame* frame, CanSubscriber* owner);
+
+    private:
+        /// Кадр пула
+        CanPoolFrame* mFrame = nullptr;
+        /// Подписчик-владелец ссылки
+        CanSubscriber* mOwner = nullptr;
+    };
+} // namespace hardware
+
+#endif // HARDWARE_CAN_FRAME_POOL_H
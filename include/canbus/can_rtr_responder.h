@@ -0,0 +1,114 @@
+#ifndef HARDWARE_CAN_RTR_RESPONDER_H
+#define HARDWARE_CAN_RTR_RESPONDER_H
+
+#include "can_frame.h"
+
+namespace canbus
+{
+    /**
+     * @brief Константы таблицы ответов на удаленные запросы
+     */
+    constexpr uint8_t CAN_NUM_RTR_RESPONDER = 16; ///< Количество записей таблицы
+
+    /**
+     * @brief Статистика ответов на удаленные запросы
+     * @note Задержка измеряется от возврата twai_receive до постановки ответа в очередь драйвера:
+     * ожидание арбитража и передача кадра по шине в нее не входят
+     */
+    struct CanRtrStats
+    {
+        uint32_t requests = 0;    ///< Количество запросов с записью в таблице
+        uint32_t responses = 0;   ///< Количество поставленных в очередь ответов
+        uint32_t failures = 0;    ///< Количество ответов, не принятых драйвером
+        uint32_t lastQueueUs = 0; ///< Задержка постановки последнего ответа в очередь (мкс)
+        uint32_t maxQueueUs = 0;  ///< Максимальная задержка постановки в очередь (мкс)
+        uint32_t avgQueueUs = 0;  ///< Средняя задержка постановки в очередь (мкс)
+    };
+
+    /**
+     * @brief Таблица ответов на удаленные (RTR) запросы
+     * @note Данные обновляются приложением, чтение выполняет задача приема
+     */
+    class CanRtrResponder
+    {
+    public:
+        CanRtrResponder() = default;
+
+        // Запрет копирования
+        CanRtrResponder(const CanRtrResponder&) = delete;
+        CanRtrResponder& operator=(const CanRtrResponder&) = delete;
+
+        /**
+         * @brief Установка ответа (запись ищется по id и формату)
+         * @param frame Кадр ответа
+         * @return Индекс записи или -1 при ошибке
+         */
+        int set(const CanFrame& frame);
+
+        /**
+         * @brief Обновление данных ответа
+         * @param id Идентификатор
+         * @param extended Флаг расширенного формата
+         * @param data Данные
+         * @param length Длина данных (0-8)
+         * @return true если запись найдена
+         */
+        bool update(uint32_t id, bool extended, const uint8_t* data, uint8_t length);
+
+        /**
+         * @brief Удаление ответа
+         * @param id Идентификатор
+         * @param extended Флаг расширенного формата
+         */
+        void remove(uint32_t id, bool extended);
+
+        /**
+         * @brief Очистить таблицу
+         */
+        void clear();
+
+        /**
+         * @brief Подготовка ответа на запрос
+         * @param id Идентификатор запроса
+         * @param extended Флаг расширенного формата
+         * @param frame Кадр ответа для заполнения
+         * @return true если ответ найден
+         */
+        bool prepare(uint32_t id, bool extended, CanFrame& frame);
+
+        /**
+         * @brief Учет результата ответа
+         * @param sent Ответ поставлен в очередь передачи
+         * @param queueUs Задержка от приема запроса до постановки в очередь (мкс)
+         */
+        void account(bool sent, uint32_t queueUs);
+
+        /**
+         * @brief Получить статистику
+         * @return Статистика ответов
+         */
+        [[nodiscard]] CanRtrStats getStats() const;
+
+    private:
+        /**
+         * @brief Поиск записи
+         * @param id Идентификатор
+         * @param extended Флаг расширенного формата
+         * @return Индекс записи или -1
+         */
+        [[nodiscard]] int find(uint32_t id, bool extended) const;
+
+        /// Флаги занятости записей
+        bool mUsed[CAN_NUM_RTR_RESPONDER] = {};
+        /// Кадры ответов
+        CanFrame mFrames[CAN_NUM_RTR_RESPONDER];
+        /// Блокировка таблицы
+        mutable portMUX_TYPE mLock = portMUX_INITIALIZER_UNLOCKED;
+        /// Статистика
+        CanRtrStats mStats;
+        /// Суммарная задержка постановки ответов в очередь (мкс)
+        uint64_t mTotalQueueUs = 0;
+    };
+} // namespace hardware
+
+#endif // HARDWARE_CAN_RTR_RESPONDER_H
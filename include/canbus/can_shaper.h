@@ -0,0 +1,232 @@
+#ifndef HARDWARE_CAN_SHAPER_H
+#define HARDWARE_CAN_SHAPER_H
+
+#include "can_frame.h"
+
+namespace canbus
+{
+    /**
+     * @brief Константы ограничителя передачи
+     */
+    constexpr uint8_t CAN_NUM_SHAPER_RULE = 16;      ///< Количество правил ограничения
+    constexpr uint16_t CAN_SHAPER_WINDOW_MS = 100;   ///< Окно бюджета и измерения загрузки (мс)
+    constexpr uint16_t CAN_SHAPER_MAX_DELAY_MS = 20; ///< Максимальная задержка отправки (мс)
+    constexpr uint8_t CAN_SHAPER_NUM_PENDING = 16;   ///< Количество отложенных кадров (по одному на ID)
+
+    /**
+     * @brief Поведение при превышении лимита
+     */
+    enum class CanShapePolicy : uint8_t
+    {
+        DELAY,   ///< Задержать отправку (не более CAN_SHAPER_MAX_DELAY_MS)
+        DROP,    ///< Отбросить кадр
+        COALESCE ///< Сохранить последние данные и отправить при появлении ресурса (и для кадров без правила)
+    };
+
+    /**
+     * @brief Решение ограничителя
+     */
+    enum class CanShapeResult : uint8_t
+    {
+        SEND,     ///< Кадр можно отправлять
+        DELAY,    ///< Отправку нужно повторить позже
+        DROP,     ///< Кадр отброшен
+        COALESCED ///< Кадр сохранен для отложенной отправки
+    };
+
+    /**
+     * @brief Правило ограничения (token bucket на ID или диапазон ID)
+     */
+    struct CanShaperRule
+    {
+        bool configured = false;                       ///< Флаг настройки правила
+        bool extended = false;                         ///< Флаг расширенного формата
+        uint32_t id = 0;                               ///< Идентификатор
+        uint32_t mask = 0;                             ///< Маска
+        uint16_t rate = 0;                             ///< Скорость (кадров/с)
+        uint8_t burst = 1;                             ///< Размер пачки (кадров)
+        CanShapePolicy policy = CanShapePolicy::DELAY; ///< Поведение при превышении
+    };
+
+    /**
+     * @brief Статистика ограничителя
+     */
+    struct CanShaperStats
+    {
+        uint8_t budgetPercent = 100; ///< Бюджет загрузки шины (%)
+        uint8_t loadPercent = 0;     ///< Загрузка собственной передачей за последнее окно (%)
+        uint32_t budgetBits = 0;     ///< Доступный остаток бюджета (бит)
+        uint32_t sent = 0;           ///< Количество пропущенных кадров
+        uint32_t delayed = 0;        ///< Количество задержанных отправок
+        uint32_t dropped = 0;        ///< Количество отброшенных кадров
+        uint32_t coalesced = 0;      ///< Количество объединенных кадров
+        uint32_t superseded = 0;     ///< Количество отложенных кадров, замененных новыми данными того же ID
+    };
+
+    /**
+     * @brief Ограничитель передачи и бюджет загрузки шины
+     * @note Не потокобезопасен, вызывается в критической секции Can: методы не блокируют
+     * и не ведут журнал
+     */
+    class CanShaper
+    {
+    public:
+        /**
+         * @brief Длина кадра на шине с учетом худшего случая bit stuffing
+         * @param frame CAN-кадр
+         * @return Длина кадра (бит)
+         */
+        static uint32_t frameBits(const CanFrame& frame);
+
+        /**
+         * @brief Установка скорости шины
+         * @param bitrate Скорость (бит/с)
+         */
+        void setBitrate(uint32_t bitrate);
+
+        /**
+         * @brief Установка бюджета загрузки шины
+         * @param percent Бюджет (%), 100 - без ограничения
+         * @param policy Поведение при превышении для кадров без правила
+         */
+        void setBudget(uint8_t percent, CanShapePolicy policy);
+
+        /**
+         * @brief Установка правила
+         * @param index Индекс правила
+         * @param rule Параметры правила
+         * @return true если правило установлено
+         */
+        bool setRule(uint8_t index, const CanShaperRule& rule);
+
+        /**
+         * @brief Получить правило
+         * @param index Индекс правила
+         * @return Параметры правила
+         */
+        [[nodiscard]] CanShaperRule getRule(int8_t index) const;
+
+        /**
+         * @brief Очистить все правила
+         */
+        void clearRules();
+
+        /**
+         * @brief Проверка кадра перед отправкой
+         * @param frame CAN-кадр
+         * @param waited Время ожидания текущей отправки (мс)
+         * @return Решение ограничителя
+         */
+        CanShapeResult admit(const CanFrame& frame, unsigned long waited = 0);
+
+        /**
+         * @brief Учет кадра, отправленного в обход ограничителя (ответы RTR, SYNC времени)
+         * @param frame CAN-кадр
+         */
+        void account(const CanFrame& frame);
+
+        /**
+         * @brief Время до появления ресурса для ближайшего отложенного кадра
+         * @return Время ожидания (мкс), 0 - кадр можно отправить, UINT32_MAX - отложенных кадров нет
+         */
+        uint32_t getPendingWait();
+
+        /**
+         * @brief Получить отложенный кадр, для которого появился ресурс
+         * @param frame CAN-кадр для заполнения
+         * @return true если кадр получен
+         */
+        bool takePending(CanFrame& frame);
+
+        /**
+         * @brief Получить статистику
+         * @return Статистика ограничителя
+         */
+        [[nodiscard]] CanShaperStats getStats() const;
+
+    private:
+        /**
+         * @brief Состояние правила
+         */
+        struct RuleState
+        {
+            uint32_t credit = 0;        ///< Накопленный ресурс (мкс)
+            unsigned long lastTime = 0; ///< Время последнего пополнения (мкс)
+        };
+
+        /**
+         * @brief Отложенный кадр (последние данные ID)
+         */
+        struct Pending
+        {
+            bool used = false; ///< Флаг занятости
+            int8_t rule = -1;  ///< Индекс правила или -1 (кадр без правила, бюджет шины)
+            CanFrame frame;    ///< Кадр
+        };
+
+        /**
+         * @brief Пополнение ресурсов
+         * @param now Текущее время (мкс)
+         */
+        void refill(unsigned long now);
+
+        /**
+         * @brief Поиск правила для кадра
+         * @param frame CAN-кадр
+         * @return Индекс правила или -1
+         */
+        [[nodiscard]] int findRule(const CanFrame& frame) const;
+
+        /**
+         * @brief Поиск отложенного кадра с тем же ID
+         * @param frame CAN-кадр
+         * @return Индекс отложенного кадра или -1
+         */
+        [[nodiscard]] int findPending(const CanFrame& frame) const;
+
+        /**
+         * @brief Удаление отложенных кадров правила
+         * @param ruleIndex Индекс правила
+         */
+        void clearPending(int ruleIndex);
+
+        /**
+         * @brief Стоимость кадра для правила
+         * @param rule Правило
+         * @return Стоимость (мкс ресурса)
+         */
+        static uint32_t ruleCost(const CanShaperRule& rule);
+
+        /**
+         * @brief Списание ресурсов за отправленный кадр
+         * @param ruleIndex Индекс правила или -1
+         * @param bits Длина кадра (бит)
+         */
+        void consume(int ruleIndex, uint32_t bits);
+
+        /// Правила ограничения
+        CanShaperRule mRules[CAN_NUM_SHAPER_RULE];
+        /// Состояния правил
+        RuleState mStates[CAN_NUM_SHAPER_RULE];
+        /// Отложенные кадры
+        Pending mPending[CAN_SHAPER_NUM_PENDING];
+        /// Скорость шины (бит/с)
+        uint32_t mBitrate = 125000;
+        /// Бюджет загрузки (%)
+        uint8_t mBudgetPercent = 100;
+        /// Поведение при превышении бюджета
+        CanShapePolicy mBudgetPolicy = CanShapePolicy::DELAY;
+        /// Остаток бюджета (бит)
+        uint32_t mBudgetBits = 0;
+        /// Время последнего пополнения бюджета (мкс)
+        unsigned long mBudgetTime = 0;
+        /// Начало окна измерения загрузки (мкс)
+        unsigned long mWindowStart = 0;
+        /// Передано бит в текущем окне
+        uint32_t mWindowBits = 0;
+        /// Статистика
+        CanShaperStats mStats;
+    };
+} // namespace hardware
+
+#endif // HARDWARE_CAN_SHAPER_H
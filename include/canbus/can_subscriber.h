@@ -0,0 +1,171 @@
+#ifndef HARDWARE_CAN_SUBSCRIBER_H
+#define HARDWARE_CAN_SUBSCRIBER_H
+
+#include "can_frame_pool.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+namespace canbus
+{
+    /**
+     * @brief Константы подписчика
+     */
+    constexpr uint8_t CAN_NUM_SUBSCRIBER = 8;         ///< Максимальное количество подписчиков
+    constexpr uint8_t CAN_SUBSCRIBER_NUM_FILTER = 8;  ///< Количество фильтров подписчика
+    constexpr uint8_t CAN_SUBSCRIBER_QUEUE_SIZE = 16; ///< Глубина очереди по умолчанию
+
+    /**
+     * @brief Поведение при переполнении очереди подписчика
+     */
+    enum class CanOverflowPolicy : uint8_t
+    {
+        DROP_NEWEST, ///< Отбросить новый кадр
+        DROP_OLDEST  ///< Вытеснить самый старый кадр
+    };
+
+    /**
+     * @brief Фильтр подписчика
+     */
+    struct CanSubscriberFilter
+    {
+        bool extended = false; ///< Флаг расширенного формата
+        uint32_t id = 0;       ///< Идентификатор
+        uint32_t mask = 0;     ///< Маска
+    };
+
+    class Can;
+
+    /**
+     * @brief Подписчик на принятые кадры
+     * @note Хранит ограниченную очередь ссылок на разделяемые кадры пула.
+     * Подписчик резервирует в пуле кадры по глубине очереди и не может занять больше:
+     * очередь и полученные CanFrameRef вместе ограничены резервом, при его исчерпании
+     * применяется собственное поведение при переполнении. Фильтры настраиваются до вызова
+     * Can::subscribe()
+     */
+    class CanSubscriber
+    {
+    public:
+        /**
+         * @brief Конструктор
+         * @param queueSize Глубина очереди ссылок
+         * @param policy Поведение при переполнении
+         */
+        explicit CanSubscriber(uint8_t queueSize = CAN_SUBSCRIBER_QUEUE_SIZE,
+                               CanOverflowPolicy policy = CanOverflowPolicy::DROP_NEWEST);
+
+        /**
+         * @brief Деструктор (подписчик отключается от Can)
+         */
+        ~CanSubscriber();
+
+        // Запрет копирования
+        CanSubscriber(const CanSubscriber&) = delete;
+        CanSubscriber& operator=(const CanSubscriber&) = delete;
+
+        /**
+         * @brief Добавление фильтра (без фильтров принимаются все кадры)
+         * @param id Идентификатор
+         * @param mask Маска
+         * @param extended Флаг расширенного формата
+         * @return Индекс фильтра или -1 при ошибке
+         */
+        int addFilter(uint32_t id, uint32_t mask, bool extended);
+
+        /**
+         * @brief Очистить фильтры подписчика
+         */
+        void clearFilters();
+
+        /**
+         * @brief Проверка кадра фильтрами подписчика
+         * @param frame CAN-кадр
+         * @return true если кадр предназначен подписчику
+         */
+        [[nodiscard]] bool matches(const CanFrame& frame) const;
+
+        /**
+         * @brief Получить ссылку на кадр из очереди
+         * @param ref Ссылка для заполнения
+         * @param timeout Таймаут ожидания (мс)
+         * @return true если кадр получен
+         */
+        bool receive(CanFrameRef& ref, uint32_t timeout = 0);
+
+        /**
+         * @brief Количество кадров в очереди
+         */
+        [[nodiscard]] uint8_t pending() const;
+
+        /**
+         * @brief Глубина очереди (резерв кадров пула)
+         */
+        [[nodiscard]] uint8_t getQueueSize() const;
+
+        /**
+         * @brief Количество отброшенных кадров
+         */
+        [[nodiscard]] uint32_t getDropped() const;
+
+        /**
+         * @brief Количество доставленных в очередь кадров
+         */
+        [[nodiscard]] uint32_t getDelivered() const;
+
+    protected:
+        /**
+         * @brief Дружественный класс CAN-интерфейса
+         */
+        friend class Can;
+
+        /**
+         * @brief Дружественный класс ссылки на кадр
+         */
+        friend class CanFrameRef;
+
+        /**
+         * @brief Поставить кадр в очередь без ожидания
+         * @param frame Кадр пула (ссылка увеличивается при успехе)
+         * @return true если кадр поставлен в очередь
+         */
+        bool push(CanPoolFrame* frame);
+
+        /**
+         * @brief Учет отброшенного кадра
+         */
+        void drop();
+
+        /**
+         * @brief Возврат резерва освобожденной ссылкой
+         */
+        void releaseRef();
+
+    private:
+        /**
+         * @brief Вытеснение самого старого кадра очереди
+         * @return true если кадр вытеснен
+         */
+        bool dropOldest();
+
+        /// Очередь ссылок на кадры пула
+        QueueHandle_t mQueue = nullptr;
+        /// Глубина очереди (резерв кадров пула)
+        uint8_t mQueueSize;
+        /// Занятые кадры пула: в очереди и в полученных ссылках
+        std::atomic<uint8_t> mOutstanding{0};
+        /// CAN-интерфейс, к которому подключен подписчик
+        Can* mCan = nullptr;
+        /// Поведение при переполнении
+        CanOverflowPolicy mPolicy;
+        /// Фильтры подписчика
+        CanSubscriberFilter mFilters[CAN_SUBSCRIBER_NUM_FILTER];
+        /// Количество фильтров
+        uint8_t mNumFilters = 0;
+        /// Счетчик отброшенных кадров
+        uint32_t mDropped = 0;
+        /// Счетчик доставленных кадров
+        uint32_t mDelivered = 0;
+    };
+} // namespace hardware
+
+#endif // HARDWARE_CAN_SUBSCRIBER_H
@@ -0,0 +1,63 @@
+#ifndef HARDWARE_CAN_TASK_CONTROL_H
+#define HARDWARE_CAN_TASK_CONTROL_H
+
+#include <atomic>
+#include "esp32_c3_objects/thread.h"
+
+namespace canbus
+{
+    constexpr uint16_t CAN_TASK_STOP_POLL_MS = 10; ///< Шаг проверки запроса остановки в паузе задачи (мс)
+
+    /**
+     * @brief Кооперативный запуск и остановка задачи
+     * @note Задача проверяет запрос остановки между итерациями, когда не удерживает семафоры
+     * и кадры пула, и подтверждает его вызовом park(). Поток удаляется только после подтверждения
+     */
+    class CanTaskControl
+    {
+    public:
+        /**
+         * @brief Запуск задачи
+         * @param thread Поток
+         * @param function Функция задачи
+         * @param params Параметры задачи
+         * @return true если задача запущена
+         */
+        bool start(esp32_c3_objects::Thread& thread, TaskFunction_t function, void* params);
+
+        /**
+         * @brief Остановка задачи в безопасной точке
+         * @param thread Поток
+         * @note Ожидает подтверждения от задачи, не вызывать из самой задачи
+         */
+        void stop(esp32_c3_objects::Thread& thread);
+
+        /**
+         * @brief Проверка запроса остановки (вызывается задачей)
+         * @return true если задача должна продолжать работу
+         */
+        [[nodiscard]] bool running() const;
+
+        /**
+         * @brief Пауза с проверкой запроса остановки (вызывается задачей)
+         * @param ms Длительность паузы (мс)
+         * @return true если задача должна продолжать работу
+         */
+        bool delay(uint32_t ms) const;
+
+        /**
+         * @brief Подтверждение остановки и ожидание удаления (вызывается задачей)
+         */
+        [[noreturn]] void park();
+
+    private:
+        /// Флаг запущенной задачи
+        bool mActive = false;
+        /// Запрос остановки
+        std::atomic<bool> mStopRequested{false};
+        /// Подтверждение остановки задачей
+        std::atomic<bool> mParked{false};
+    };
+} // namespace hardware
+
+#endif // HARDWARE_CAN_TASK_CONTROL_H
@@ -0,0 +1,170 @@
+#ifndef HARDWARE_CAN_TIME_SYNC_H
+#define HARDWARE_CAN_TIME_SYNC_H
+
+#include "can.h"
+#include "can_clock_servo.h"
+
+namespace canbus
+{
+    /**
+     * @brief Константы синхронизации времени
+     */
+    constexpr uint32_t CAN_TIME_SYNC_ID = 0x7F0;        ///< Идентификатор кадра SYNC по умолчанию
+    constexpr uint32_t CAN_TIME_FOLLOW_UP_ID = 0x7F1;   ///< Идентификатор кадра FOLLOW_UP по умолчанию
+    constexpr uint16_t CAN_TIME_SYNC_PERIOD = 1000;     ///< Период синхронизации по умолчанию (мс)
+    constexpr uint16_t CAN_TIME_SYNC_TX_TIMEOUT_MS = 10; ///< Ожидание завершения передачи SYNC (мс)
+
+    /**
+     * @brief Роль узла
+     */
+    enum class CanTimeSyncRole : uint8_t
+    {
+        SLAVE, ///< Подстройка под ведущий узел
+        MASTER ///< Рассылка времени
+    };
+
+    /**
+     * @brief Параметры синхронизации времени
+     */
+    struct CanTimeSyncConfig
+    {
+        CanTimeSyncRole role = CanTimeSyncRole::SLAVE;  ///< Роль узла
+        uint32_t syncId = CAN_TIME_SYNC_ID;             ///< Идентификатор кадра SYNC
+        uint32_t followUpId = CAN_TIME_FOLLOW_UP_ID;    ///< Идентификатор кадра FOLLOW_UP
+        bool extended = false;                          ///< Флаг расширенного формата
+        uint16_t period = CAN_TIME_SYNC_PERIOD;         ///< Период синхронизации (мс)
+    };
+
+    /**
+     * @brief Статистика синхронизации времени
+     */
+    struct CanTimeSyncStats
+    {
+        bool locked = false;     ///< Оценка смещения и дрейфа установилась
+        uint32_t syncs = 0;      ///< Количество отправленных/принятых SYNC
+        uint32_t followUps = 0;  ///< Количество отправленных/принятых FOLLOW_UP
+        uint32_t missed = 0;     ///< Количество SYNC без парного FOLLOW_UP
+        int32_t lastErrorUs = 0; ///< Ошибка последнего отсчета (мкс)
+        int32_t driftPpb = 0;    ///< Коррекция частоты локальных часов (ppb)
+    };
+
+    /**
+     * @brief Синхронизация времени узлов по CAN (двухшаговая схема SYNC + FOLLOW_UP)
+     * @note Ведущий узел отправляет SYNC, фиксирует момент завершения передачи и передает его
+     * в FOLLOW_UP. Ведомый сопоставляет его с моментом приема SYNC.
+     */
+    class CanTimeSync
+    {
+    public:
+        /**
+         * @brief Конструктор
+         * @param can CAN-интерфейс
+         */
+        explicit CanTimeSync(Can& can);
+
+        /**
+         * @brief Деструктор
+         */
+        ~CanTimeSync();
+
+        // Запрет копирования
+        CanTimeSync(const CanTimeSync&) = delete;
+        CanTimeSync& operator=(const CanTimeSync&) = delete;
+
+        /**
+         * @brief Запуск синхронизации
+         * @param config Параметры синхронизации
+         * @return true если синхронизация запущена
+         */
+        bool begin(const CanTimeSyncConfig& config);
+
+        /**
+         * @brief Остановка синхронизации
+         * @note Задача ведущего узла останавливается между рассылками (вне семафора Can),
+         * затем синхронизация отключается от Can с ожиданием задачи приема и getTime()
+         */
+        void end();
+
+        /**
+         * @brief Текущее время в общей шкале
+         * @return Время (мкс)
+         */
+        [[nodiscard]] int64_t getTime() const;
+
+        /**
+         * @brief Перевод локального времени esp_timer в общую шкалу
+         * @param localTime Локальное время (мкс)
+         * @return Время в общей шкале (мкс)
+         */
+        [[nodiscard]] int64_t toSharedTime(int64_t localTime) const;
+
+        /**
+         * @brief Проверка синхронизации
+         * @return true если узел ведущий или ведомый захватил время ведущего
+         */
+        [[nodiscard]] bool isSynchronized() const;
+
+        /**
+         * @brief Получить статистику
+         * @return Статистика синхронизации
+         */
+        [[nodiscard]] CanTimeSyncStats getStats() const;
+
+    protected:
+        /**
+         * @brief Дружественный класс CAN-интерфейса
+         */
+        friend class Can;
+
+        /**
+         * @brief Дружественная функция для задачи ведущего узла
+         */
+        friend void canTimeSyncTask(void* params);
+
+        /**
+         * @brief Обработка принятого кадра (вызывается задачей приема)
+         * @param frame Принятый кадр
+         * @param rxTime Локальное время приема (мкс)
+         * @return true если кадр относится к синхронизации
+         */
+        bool processFrame(const CanFrame& frame, int64_t rxTime);
+
+        /**
+         * @brief Рассылка SYNC и FOLLOW_UP ведущим узлом
+         */
+        void handleMaster();
+
+    private:
+        /**
+         * @brief Ожидание завершения передачи SYNC
+         * @param txTime Время завершения передачи (мкс)
+         * @return true если передача подтверждена драйвером
+         */
+        static bool waitTxComplete(int64_t& txTime);
+
+        /// CAN-интерфейс
+        Can& mCan;
+        /// Поток ведущего узла
+        esp32_c3_objects::Thread mThread;
+        /// Управление остановкой задачи ведущего узла
+        CanTaskControl mControl;
+        /// Параметры синхронизации
+        CanTimeSyncConfig mConfig;
+        /// Флаг запуска
+        bool mStarted = false;
+        /// Фильтр оценки смещения и дрейфа
+        CanClockServo mServo;
+        /// Блокировка фильтра
+        mutable portMUX_TYPE mLock = portMUX_INITIALIZER_UNLOCKED;
+        /// Номер последовательности SYNC
+        uint8_t mSequence = 0;
+        /// Ожидание FOLLOW_UP для принятого SYNC
+        bool mSyncPending = false;
+        /// Локальное время приема последнего SYNC (мкс)
+        int64_t mSyncRxTime = 0;
+        /// Статистика
+        CanTimeSyncStats mStats;
+    };
+} // namespace hardware
+
+#endif // HARDWARE_CAN_TIME_SYNC_H
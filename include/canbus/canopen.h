@@ -0,0 +1,301 @@
+#ifndef HARDWARE_CANOPEN_H
+#define HARDWARE_CANOPEN_H
+
+#include "can.h"
+#include "canopen_pdo.h"
+
+namespace canbus
+{
+    /**
+     * @brief Константы CANopen
+     */
+    constexpr uint8_t CANOPEN_NUM_RPDO = 4;                  ///< Количество RPDO
+    constexpr uint8_t CANOPEN_NUM_TPDO = 4;                  ///< Количество TPDO
+    constexpr uint32_t CANOPEN_SYNC_COB_ID = 0x80;           ///< COB-ID кадра SYNC
+    constexpr uint32_t CANOPEN_COB_ID_INVALID = 0x80000000;  ///< Бит отключения PDO в COB-ID
+    constexpr uint32_t CANOPEN_COB_ID_EXTENDED = 0x20000000; ///< Бит 29-битного идентификатора в COB-ID
+    constexpr uint8_t CANOPEN_TRANSMISSION_SYNC_MAX = 240;   ///< Максимальный тип синхронной передачи
+    constexpr uint8_t CANOPEN_TRANSMISSION_EVENT = 254;      ///< Тип передачи по событию
+    constexpr uint16_t CANOPEN_MAX_WAIT_MS = 100;            ///< Максимальное ожидание кадра задачей (мс)
+    constexpr uint16_t CANOPEN_SEND_RETRY_MS = 100;          ///< Минимальный интервал повтора неотправленного TPDO (мс)
+
+    static_assert(CANOPEN_PDO_MAX_LENGTH == CAN_FRAME_DATA_SIZE, "PDO length must match CAN frame data size");
+
+    /**
+     * @brief Статистика PDO
+     */
+    struct CanOpenPdoStats
+    {
+        uint32_t count = 0;      ///< Количество обработанных PDO
+        uint32_t lastCycles = 0; ///< Время упаковки/распаковки последнего PDO (такты CPU)
+        uint32_t maxCycles = 0;  ///< Максимальное время упаковки/распаковки (такты CPU)
+    };
+
+    /**
+     * @brief Статистика SYNC
+     */
+    struct CanOpenSyncStats
+    {
+        uint32_t syncs = 0;         ///< Количество принятых SYNC
+        uint32_t lastLatencyUs = 0; ///< Задержка от приема SYNC до отправки TPDO (мкс)
+        uint32_t maxLatencyUs = 0;  ///< Максимальная задержка SYNC - TPDO (мкс)
+    };
+
+    /**
+     * @brief Узел CANopen с отображением PDO
+     * @note Кадры принимаются через подписчика Can, обработка выполняется собственной задачей.
+     * Циклические TPDO используют механизм CanFrame::frequency / nextSendTime.
+     */
+    class CanOpen
+    {
+    public:
+        /**
+         * @brief Конструктор
+         * @param can CAN-интерфейс
+         * @param dictionary Словарь объектов
+         * @param nodeId Номер узла (1-127)
+         */
+        CanOpen(Can& can, CanOpenDictionary& dictionary, uint8_t nodeId);
+
+        /**
+         * @brief Деструктор
+         */
+        ~CanOpen();
+
+        // Запрет копирования
+        CanOpen(const CanOpen&) = delete;
+        CanOpen& operator=(const CanOpen&) = delete;
+
+        /**
+         * @brief COB-ID RPDO по умолчанию (predefined connection set)
+         * @param num Номер RPDO (0-3)
+         * @return COB-ID
+         */
+        [[nodiscard]] uint32_t getDefaultRpdoCobId(uint8_t num) const;
+
+        /**
+         * @brief COB-ID TPDO по умолчанию (predefined connection set)
+         * @param num Номер TPDO (0-3)
+         * @return COB-ID
+         */
+        [[nodiscard]] uint32_t getDefaultTpdoCobId(uint8_t num) const;
+
+        /**
+         * @brief Настройка RPDO (отображение компилируется в план распаковки)
+         * @param num Номер RPDO
+         * @param cobId COB-ID
+         * @param transmissionType Тип передачи (0-240 - применение по SYNC, 254/255 - сразу)
+         * @param mappings Записи отображения
+         * @param count Количество записей
+         * @return true если RPDO настроен и подписка на его COB-ID действует; false для
+         * зарезервированных типов 241-253, ошибки отображения или отказа Can::subscribe()
+         */
+        bool setRpdo(uint8_t num, uint32_t cobId, uint8_t transmissionType, const uint32_t mappings[], uint8_t count);
+
+        /**
+         * @brief Настройка TPDO (отображение компилируется в план упаковки)
+         * @param num Номер TPDO
+         * @param cobId COB-ID
+         * @param transmissionType Тип передачи (0 - по событию на SYNC, 1-240 - каждый N-й SYNC,
+         * 254/255 - по событию и таймеру)
+         * @param eventTimer Период циклической передачи для типов 254/255 (мс, 0 - отключено)
+         * @param mappings Записи отображения
+         * @param count Количество записей
+         * @return true если TPDO настроен; false для зарезервированных типов 241-253
+         * или ошибки отображения
+         */
+        bool setTpdo(uint8_t num, uint32_t cobId, uint8_t transmissionType, uint16_t eventTimer,
+                     const uint32_t mappings[], uint8_t count);
+
+        /**
+         * @brief Событие изменения данных TPDO
+         * @param num Номер TPDO
+         * @return true если TPDO отправлен или поставлен на ближайший SYNC
+         */
+        bool triggerTpdo(uint8_t num);
+
+        /**
+         * @brief Запуск обработки PDO
+         * @return true если обработка запущена (false и при отказе Can::subscribe(),
+         * например при исчерпании резерва пула кадров)
+         */
+        bool begin();
+
+        /**
+         * @brief Остановка обработки PDO
+         * @note Задача останавливается между итерациями: вне семафоров CanOpen и Can
+         * и без удерживаемых кадров пула
+         */
+        void end();
+
+        /**
+         * @brief Получить статистику RPDO
+         * @param num Номер RPDO
+         * @return Статистика распаковки
+         */
+        [[nodiscard]] CanOpenPdoStats getRpdoStats(uint8_t num) const;
+
+        /**
+         * @brief Получить статистику TPDO
+         * @param num Номер TPDO
+         * @return Статистика упаковки
+         */
+        [[nodiscard]] CanOpenPdoStats getTpdoStats(uint8_t num) const;
+
+        /**
+         * @brief Получить статистику SYNC
+         * @return Статистика SYNC и задержка SYNC - TPDO
+         */
+        [[nodiscard]] CanOpenSyncStats getSyncStats() const;
+
+    protected:
+        /**
+         * @brief Дружественная функция для задачи обработки
+         */
+        friend void canOpenTask(void* params);
+
+        /**
+         * @brief Обработка принятых кадров и циклических TPDO
+         */
+        void handle();
+
+    private:
+        /**
+         * @brief Состояние RPDO
+         */
+        struct Rpdo
+        {
+            bool valid = false;                                    ///< Флаг настройки
+            uint32_t id = 0;                                       ///< Идентификатор кадра
+            bool extended = false;                                 ///< Флаг расширенного формата
+            uint8_t transmissionType = CANOPEN_TRANSMISSION_EVENT; ///< Тип передачи
+            CanOpenPdoPlan plan;                                   ///< План распаковки
+            bool syncPending = false;                              ///< Данные ожидают SYNC
+            uint8_t data[CAN_FRAME_DATA_SIZE] = {};                ///< Данные, ожидающие SYNC
+            uint8_t length = 0;                                    ///< Длина данных, ожидающих SYNC
+            CanOpenPdoStats stats;                                 ///< Статистика
+        };
+
+        /**
+         * @brief Состояние TPDO
+         */
+        struct Tpdo
+        {
+            bool valid = false;                                    ///< Флаг настройки
+            uint8_t transmissionType = CANOPEN_TRANSMISSION_EVENT; ///< Тип передачи
+            uint8_t syncCount = 0;                                 ///< Счетчик SYNC
+            bool eventPending = false;                             ///< Событие ожидает SYNC
+            CanOpenPdoPlan plan;                                   ///< План упаковки
+            CanFrame frame;                                        ///< Кадр TPDO
+            CanOpenPdoStats stats;                                 ///< Статистика
+        };
+
+        /**
+         * @brief Запись индекса диспетчеризации RPDO
+         */
+        struct Dispatch
+        {
+            uint32_t key = 0; ///< Идентификатор с флагом формата
+            uint8_t rpdo = 0; ///< Номер RPDO
+        };
+
+        /**
+         * @brief Ключ индекса диспетчеризации
+         * @param id Идентификатор кадра
+         * @param extended Флаг расширенного формата
+         * @return Ключ
+         */
+        static uint32_t dispatchKey(uint32_t id, bool extended);
+
+        /**
+         * @brief Перестроение отсортированного индекса RPDO по COB-ID
+         */
+        void rebuildDispatch();
+
+        /**
+         * @brief Поиск RPDO по идентификатору (двоичный поиск)
+         * @param id Идентификатор кадра
+         * @param extended Флаг расширенного формата
+         * @return Номер RPDO или -1
+         */
+        [[nodiscard]] int findRpdo(uint32_t id, bool extended) const;
+
+        /**
+         * @brief Проверка типа передачи PDO
+         * @param transmissionType Тип передачи
+         * @return true если тип не зарезервирован (0-240, 254, 255)
+         */
+        static bool isValidTransmissionType(uint8_t transmissionType);
+
+        /**
+         * @brief Обновление фильтров подписчика
+         * @return true если подписчик подключен к Can
+         */
+        bool updateSubscription();
+
+        /**
+         * @brief Обработка SYNC
+         * @param sync Кадр SYNC
+         */
+        void processSync(const CanFrame& sync);
+
+        /**
+         * @brief Обработка RPDO
+         * @param num Номер RPDO
+         * @param frame Принятый кадр
+         */
+        void processRpdo(uint8_t num, const CanFrame& frame);
+
+        /**
+         * @brief Распаковка RPDO с измерением времени
+         * @param rpdo RPDO
+         * @param data Данные
+         * @param length Длина данных
+         */
+        static void unpackRpdo(Rpdo& rpdo, const uint8_t* data, uint8_t length);
+
+        /**
+         * @brief Упаковка и отправка TPDO
+         * @note При ошибке отправки циклический TPDO откладывается не менее чем на
+         * CANOPEN_SEND_RETRY_MS, чтобы не вызывать send() каждую миллисекунду при неготовой шине
+         * @param num Номер TPDO
+         * @return true если кадр отправлен
+         */
+        bool sendTpdo(uint8_t num);
+
+        /**
+         * @brief Время ожидания до ближайшего циклического TPDO
+         * @return Таймаут (мс)
+         */
+        [[nodiscard]] uint32_t nextTimeout() const;
+
+        /// CAN-интерфейс
+        Can& mCan;
+        /// Словарь объектов
+        CanOpenDictionary& mDictionary;
+        /// Номер узла
+        uint8_t mNodeId;
+        /// Поток обработки
+        esp32_c3_objects::Thread mThread;
+        /// Управление остановкой задачи
+        CanTaskControl mControl;
+        /// Семафор для синхронизации
+        esp32_c3_objects::Semaphore mSemaphore;
+        /// Подписчик на SYNC и RPDO
+        CanSubscriber mSubscriber;
+        /// Флаг запуска
+        bool mStarted = false;
+        /// RPDO
+        Rpdo mRpdos[CANOPEN_NUM_RPDO];
+        /// TPDO
+        Tpdo mTpdos[CANOPEN_NUM_TPDO];
+        /// Отсортированный индекс RPDO по COB-ID
+        Dispatch mDispatch[CANOPEN_NUM_RPDO];
+        /// Количество записей индекса
+        uint8_t mNumDispatch = 0;
+        /// Статистика SYNC
+        CanOpenSyncStats mSyncStats;
+    };
+} // namespace hardware
+
+#endif // HARDWARE_CANOPEN_H
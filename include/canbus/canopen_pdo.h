@@ -0,0 +1,147 @@
+#ifndef HARDWARE_CANOPEN_PDO_H
+#define HARDWARE_CANOPEN_PDO_H
+
+#include <cstdint>
+
+namespace canbus
+{
+    /**
+     * @brief Константы словаря объектов и PDO
+     */
+    constexpr uint8_t CANOPEN_NUM_OBJECT = 64;     ///< Количество объектов словаря
+    constexpr uint8_t CANOPEN_PDO_MAX_MAPPING = 8; ///< Максимальное количество отображаемых объектов PDO
+    constexpr uint8_t CANOPEN_PDO_MAX_BITS = 64;   ///< Максимальная длина данных PDO (бит)
+    constexpr uint8_t CANOPEN_PDO_MAX_LENGTH = 8;  ///< Максимальная длина данных PDO (байт)
+
+    /**
+     * @brief Объект словаря
+     */
+    struct CanOpenObject
+    {
+        uint16_t index = 0;    ///< Индекс
+        uint8_t subIndex = 0;  ///< Субиндекс
+        uint8_t bitLength = 0; ///< Длина значения (бит)
+        void* data = nullptr;  ///< Переменная приложения (little-endian)
+    };
+
+    /**
+     * @brief Словарь объектов CANopen
+     * @note Не зависит от оборудования и не ведет журнал, ошибки возвращаются вызывающему
+     */
+    class CanOpenDictionary
+    {
+    public:
+        /**
+         * @brief Добавление объекта
+         * @param index Индекс
+         * @param subIndex Субиндекс
+         * @param data Переменная приложения
+         * @param bitLength Длина значения (бит, 1-64)
+         * @return Номер объекта или -1 при ошибке
+         */
+        int add(uint16_t index, uint8_t subIndex, void* data, uint8_t bitLength);
+
+        /**
+         * @brief Добавление объекта по типу переменной
+         * @param index Индекс
+         * @param subIndex Субиндекс
+         * @param value Переменная приложения
+         * @return Номер объекта или -1 при ошибке
+         */
+        template <typename T>
+        int add(const uint16_t index, const uint8_t subIndex, T& value)
+        {
+            static_assert(sizeof(T) <= sizeof(uint64_t), "Object value is too large");
+            return add(index, subIndex, &value, sizeof(T) * 8);
+        }
+
+        /**
+         * @brief Поиск объекта
+         * @param index Индекс
+         * @param subIndex Субиндекс
+         * @return Указатель на объект или nullptr
+         */
+        [[nodiscard]] const CanOpenObject* find(uint16_t index, uint8_t subIndex) const;
+
+    private:
+        /// Объекты словаря
+        CanOpenObject mObjects[CANOPEN_NUM_OBJECT];
+        /// Количество объектов
+        uint8_t mNumObjects = 0;
+    };
+
+    /**
+     * @brief Скомпилированный план упаковки/распаковки PDO
+     * @note Выровненные по байтам объекты копируются memcpy (смежные переменные объединяются),
+     * невыровненные - сдвигами в 64-битном слове
+     */
+    class CanOpenPdoPlan
+    {
+    public:
+        /**
+         * @brief Формирование записи отображения (CiA 301)
+         * @param index Индекс объекта
+         * @param subIndex Субиндекс объекта
+         * @param bitLength Длина (бит)
+         * @return Запись отображения
+         */
+        static constexpr uint32_t mapping(const uint16_t index, const uint8_t subIndex, const uint8_t bitLength)
+        {
+            return static_cast<uint32_t>(index) << 16 | static_cast<uint32_t>(subIndex) << 8 | bitLength;
+        }
+
+        /**
+         * @brief Компиляция плана по записям отображения
+         * @param dictionary Словарь объектов
+         * @param mappings Записи отображения
+         * @param count Количество записей
+         * @return true если план построен
+         */
+        bool compile(const CanOpenDictionary& dictionary, const uint32_t mappings[], uint8_t count);
+
+        /**
+         * @brief Упаковка значений объектов в данные кадра
+         * @param data Данные кадра (CANOPEN_PDO_MAX_LENGTH байт)
+         */
+        void pack(uint8_t* data) const;
+
+        /**
+         * @brief Распаковка данных кадра в значения объектов
+         * @param data Данные кадра
+         * @param length Длина данных кадра
+         * @return true если длина кадра достаточна для плана
+         */
+        bool unpack(const uint8_t* data, uint8_t length) const;
+
+        /**
+         * @brief Длина данных PDO
+         * @return Длина (байт)
+         */
+        [[nodiscard]] uint8_t getLength() const;
+
+    private:
+        /**
+         * @brief Операция плана
+         */
+        struct Operation
+        {
+            uint8_t* data = nullptr; ///< Переменная приложения
+            uint8_t offset = 0;      ///< Смещение в кадре (байт для копирования, бит для сдвига)
+            uint8_t size = 0;        ///< Размер (байт для копирования, бит для сдвига)
+            uint8_t objectSize = 0;  ///< Размер переменной (байт)
+        };
+
+        /// Операции копирования
+        Operation mCopies[CANOPEN_PDO_MAX_MAPPING];
+        /// Количество операций копирования
+        uint8_t mNumCopies = 0;
+        /// Операции сдвига
+        Operation mShifts[CANOPEN_PDO_MAX_MAPPING];
+        /// Количество операций сдвига
+        uint8_t mNumShifts = 0;
+        /// Длина данных (байт)
+        uint8_t mLength = 0;
+    };
+} // namespace hardware
+
+#endif // HARDWARE_CANOPEN_PDO_H
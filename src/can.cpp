@@ -1,35 +1,41 @@
 #include "canbus/can.h"
+#include "canbus/can_time_sync.h"
 #include <esp32-hal-log.h>
+#include <esp_timer.h>
 
 namespace canbus
 {
     void canWatchdogTask(void* params)
     {
         auto* can = static_cast<Can*>(params);
-        constexpr TickType_t delay = 200 / portTICK_PERIOD_MS;
-        while (true)
+        uint32_t delay = CAN_WATCHDOG_MS;
+        while (can->mWatchdogControl.running())
         {
-            vTaskDelay(delay);
-            can->handleWatchdog();
+            vTaskDelay(pdMS_TO_TICKS(delay));
+            delay = can->handleWatchdog();
         }
+        can->mWatchdogControl.park();
     }
 
     void canReceiveTask(void* params)
     {
-        const auto* can = static_cast<Can*>(params);
-        while (true)
+        auto* can = static_cast<Can*>(params);
+        while (can->mReceiveControl.running())
         {
             if (!can->handleReceive())
             {
                 vTaskDelay(pdMS_TO_TICKS(CAN_RECEIVE_MS_TO_TICKS));
             }
         }
+        can->mReceiveControl.park();
     }
 
     Can::Can(gpio_num_t txPin, gpio_num_t rxPin)
         : mWatchdogThread("CAN_WATCHDOG", 2048, 10),
           mReceiveThread("CAN_RECEIVE", 4096, 19),
-          mSemaphore(true)
+          mSemaphore(true),
+          mSubscriberSemaphore(true),
+          mTimeSyncSemaphore(true)
     {
         mDriverConfig = TWAI_GENERAL_CONFIG_DEFAULT(txPin, rxPin, TWAI_MODE_NORMAL);
         mTimingConfig = TWAI_TIMING_CONFIG_125KBITS();
@@ -92,8 +98,8 @@ namespace canbus
             setSpeed(mSpeed);
             mCallback = callback;
             result = installAndStartDriver() &&
-                mReceiveThread.start(&canReceiveTask, this) &&
-                mWatchdogThread.start(&canWatchdogTask, this);
+                mReceiveControl.start(mReceiveThread, &canReceiveTask, this) &&
+                mWatchdogControl.start(mWatchdogThread, &canWatchdogTask, this);
         }
         else
         {
@@ -106,14 +112,14 @@ namespace canbus
 
     void Can::end()
     {
+        // Задачи останавливаются до захвата семафора: watchdog ожидает его при передаче отложенных кадров,
+        // задача приема не должна быть удалена внутри publishFrame() с занятым семафором подписчиков
+        mWatchdogControl.stop(mWatchdogThread);
+        mReceiveControl.stop(mReceiveThread);
+
         if (!mSemaphore.take()) return;
 
-        if (mDriverReady)
-        {
-            mWatchdogThread.stop();
-            mReceiveThread.stop();
-            stopAndUninstallDriver();
-        }
+        stopAndUninstallDriver();
 
         (void)mSemaphore.give();
     }
@@ -142,6 +148,9 @@ namespace canbus
         if (!mSemaphore.take()) return;
 
         mSpeed = speed;
+        portENTER_CRITICAL(&mTxLock);
+        mShaper.setBitrate(getBitrate(speed));
+        portEXIT_CRITICAL(&mTxLock);
         switch (speed)
         {
         case CanSpeed::SPEED_25KBIT: mTimingConfig = TWAI_TIMING_CONFIG_25KBITS();
@@ -166,6 +175,22 @@ namespace canbus
         (void)mSemaphore.give();
     }
 
+    uint32_t Can::getBitrate(const CanSpeed speed)
+    {
+        switch (speed)
+        {
+        case CanSpeed::SPEED_25KBIT: return 25000;
+        case CanSpeed::SPEED_50KBIT: return 50000;
+        case CanSpeed::SPEED_100KBIT: return 100000;
+        case CanSpeed::SPEED_125KBIT: return 125000;
+        case CanSpeed::SPEED_250KBIT: return 250000;
+        case CanSpeed::SPEED_500KBIT: return 500000;
+        case CanSpeed::SPEED_800KBIT: return 800000;
+        case CanSpeed::SPEED_1MBIT: return 1000000;
+        }
+        return 0;
+    }
+
     int Can::setFilter(const uint8_t index,
                        const uint32_t id,
                        const uint32_t mask,
@@ -180,6 +205,7 @@ namespace canbus
         filter->id = id & mask;
         filter->mask = mask;
         filter->callbackIndex = callbackIndex;
+        mE2EStates[index] = CanE2EState{};
         log_d("Filter %d set: id=0x%X, mask=0x%X", index, id, mask);
 
         (void)mSemaphore.give();
@@ -212,50 +238,318 @@ namespace canbus
         {
             filter = CanFilter{};
         }
+        for (auto& state : mE2EStates)
+        {
+            state = CanE2EState{};
+        }
         log_i("All filters cleared");
 
         (void)mSemaphore.give();
     }
 
-    void Can::processFrame(const twai_message_t& message) const
+    bool Can::setE2EProfile(const uint8_t index, const CanE2EProfile& profile)
     {
-        if (mCallback == nullptr) return;
+        if (index >= CAN_NUM_E2E_PROFILE) return false;
+        if (!CanE2E::isValid(profile))
+        {
+            log_w("Invalid E2E profile %d: crcByte=%u, counterByte=%u, counterShift=%u", index,
+                  profile.crcByte, profile.counterByte, profile.counterShift);
+            return false;
+        }
+        if (!mSemaphore.take()) return false;
 
-        for (int i = 0; i < CAN_NUM_FILTER; i++)
+        mE2EProfiles[index] = profile;
+        mE2EProfiles[index].configured = true;
+        portENTER_CRITICAL(&mTxLock);
+        mE2ECounters[index] = 0;
+        portEXIT_CRITICAL(&mTxLock);
+        log_d("E2E profile %d set: crc=%d, dataId=0x%X", index, static_cast<int>(profile.crc), profile.dataId);
+
+        (void)mSemaphore.give();
+        return true;
+    }
+
+    CanE2EProfile Can::getE2EProfile(const int8_t index) const
+    {
+        return (index >= 0 && index < CAN_NUM_E2E_PROFILE) ? mE2EProfiles[index] : CanE2EProfile{};
+    }
+
+    bool Can::setFilterE2E(const uint8_t filterIndex, const int8_t profileIndex)
+    {
+        if (filterIndex >= CAN_NUM_FILTER || profileIndex >= CAN_NUM_E2E_PROFILE || !mSemaphore.take()) return false;
+
+        mFilters[filterIndex].e2eProfile = profileIndex < 0 ? -1 : profileIndex;
+        mE2EStates[filterIndex] = CanE2EState{};
+        log_d("Filter %d E2E profile set to %d", filterIndex, profileIndex);
+
+        (void)mSemaphore.give();
+        return true;
+    }
+
+    CanE2EState Can::getE2EState(const int16_t filterIndex) const
+    {
+        return (filterIndex >= 0 && filterIndex < CAN_NUM_FILTER) ? mE2EStates[filterIndex] : CanE2EState{};
+    }
+
+    bool Can::subscribe(CanSubscriber* subscriber)
+    {
+        if (subscriber == nullptr || !mSubscriberSemaphore.take()) return false;
+
+        bool result = subscriber->mCan == this;
+        if (!result && subscriber->mCan != nullptr)
         {
-            const auto& filter = mFilters[i];
-            if (filter.configured &&
-                (message.identifier & filter.mask) == filter.id &&
-                message.extd == filter.extended)
+            log_w("Subscriber is attached to another interface");
+        }
+        else if (!result)
+        {
+            // Один кадр пула остается для приема при занятых резервах всех подписчиков
+            if (mPoolReserved + subscriber->getQueueSize() > CAN_FRAME_POOL_SIZE - 1)
             {
-                CanFrame frame;
-                frame.id = message.identifier;
-                frame.length = message.data_length_code;
-                frame.rtr = message.rtr;
-                frame.extended = message.extd;
-                frame.filterIndex = i;
-                memcpy(frame.data.bytes, message.data, CAN_FRAME_DATA_SIZE);
+                log_w("Frame pool reserve exceeded: %u + %u", mPoolReserved, subscriber->getQueueSize());
+            }
+            else
+            {
+                for (auto& item : mSubscribers)
+                {
+                    if (item == nullptr)
+                    {
+                        item = subscriber;
+                        subscriber->mCan = this;
+                        mPoolReserved += subscriber->getQueueSize();
+                        result = true;
+                        break;
+                    }
+                }
+                if (!result) log_w("No free subscriber slots available");
+            }
+        }
+
+        (void)mSubscriberSemaphore.give();
+        return result;
+    }
+
+    void Can::unsubscribe(CanSubscriber* subscriber)
+    {
+        if (subscriber == nullptr || !mSubscriberSemaphore.take()) return;
 
-                mCallback->invoke(&frame, i);
-                log_d("Frame 0x%X processed by filter %d", message.identifier, i);
-                return;
+        for (auto& item : mSubscribers)
+        {
+            if (item == subscriber)
+            {
+                item = nullptr;
+                subscriber->mCan = nullptr;
+                mPoolReserved -= subscriber->getQueueSize();
+            }
+        }
+
+        (void)mSubscriberSemaphore.give();
+    }
+
+    uint32_t Can::getPoolOverflows() const
+    {
+        return mPoolOverflows;
+    }
+
+    void Can::publishFrame(const CanFrame& frame)
+    {
+        if (!mSubscriberSemaphore.take()) return;
+
+        // Кадр копируется в пул один раз, подписчики получают ссылки в пределах своих резервов
+        CanPoolFrame* shared = nullptr;
+        bool overflow = false;
+        for (auto* subscriber : mSubscribers)
+        {
+            if (subscriber == nullptr || !subscriber->matches(frame)) continue;
+
+            if (shared == nullptr && !overflow)
+            {
+                shared = mFramePool.acquire();
+                if (shared != nullptr)
+                {
+                    shared->frame = frame;
+                }
+                else
+                {
+                    overflow = true;
+                    mPoolOverflows++;
+                }
+            }
+
+            if (shared != nullptr)
+            {
+                (void)subscriber->push(shared);
+            }
+            else
+            {
+                subscriber->drop();
             }
         }
+        CanFramePool::release(shared);
+
+        (void)mSubscriberSemaphore.give();
+    }
+
+    bool Can::respondRemote(const twai_message_t& message, const int64_t rxTime)
+    {
+        CanFrame response;
+        if (!mRtrResponder.prepare(message.identifier, message.extd, response)) return false;
+
+        // Задача приема не ожидает семафор отправителей: счетчики E2E и бюджет шины
+        // защищены критической секцией, кадр ставится в очередь драйвера без ожидания
+        const bool sent = transmit(response, 0);
+        // Ответ не ограничивается, но учитывается в бюджете и загрузке шины
+        if (sent) accountShaper(response);
+        mRtrResponder.account(sent, static_cast<uint32_t>(esp_timer_get_time() - rxTime));
+        log_d("RTR 0x%X answered from responder table", message.identifier);
+        return true;
+    }
+
+    void Can::processFrame(const twai_message_t& message, const int64_t rxTime)
+    {
+        // Запросы с записью в таблице обслуживаются без передачи приложению
+        if (message.rtr && respondRemote(message, rxTime)) return;
 
-        // Обработка кадров, не прошедших фильтрацию
         CanFrame frame;
         frame.id = message.identifier;
         frame.length = message.data_length_code;
         frame.rtr = message.rtr;
         frame.extended = message.extd;
         frame.filterIndex = -1;
+        frame.timestamp = rxTime;
         memcpy(frame.data.bytes, message.data, CAN_FRAME_DATA_SIZE);
 
-        mCallback->invoke(&frame);
-        log_d("Frame 0x%X received (no filter)", message.identifier);
+        // Синхронизация используется под семафором, чтобы setTimeSync() дожидался ее освобождения
+        if (mTimeSyncSemaphore.take())
+        {
+            bool consumed = false;
+            if (mTimeSync != nullptr)
+            {
+                consumed = mTimeSync->processFrame(frame, rxTime);
+                if (!consumed) frame.timestamp = mTimeSync->toSharedTime(rxTime);
+            }
+            (void)mTimeSyncSemaphore.give();
+            if (consumed) return;
+        }
+
+        for (int i = 0; i < CAN_NUM_FILTER; i++)
+        {
+            const auto& filter = mFilters[i];
+            if (filter.configured &&
+                (message.identifier & filter.mask) == filter.id &&
+                message.extd == filter.extended)
+            {
+                frame.filterIndex = i;
+                break;
+            }
+        }
+
+        if (frame.filterIndex >= 0)
+        {
+            const auto& filter = mFilters[frame.filterIndex];
+            if (filter.e2eProfile >= 0 && !message.rtr)
+            {
+                const auto& profile = mE2EProfiles[filter.e2eProfile];
+                frame.e2eStatus = CanE2E::check(profile, frame.data.bytes, frame.length,
+                                                mE2EStates[frame.filterIndex]);
+                if (frame.e2eStatus == CanE2EStatus::OK_SOME_LOST)
+                {
+                    log_w("Frame 0x%X E2E counter gap", message.identifier);
+                }
+                else if (CanE2E::isError(frame.e2eStatus))
+                {
+                    log_w("Frame 0x%X E2E check failed: %d", message.identifier,
+                          static_cast<int>(frame.e2eStatus));
+                    if (profile.dropInvalid) return;
+                }
+            }
+        }
+
+        publishFrame(frame);
+
+        if (mCallback == nullptr) return;
+
+        if (frame.filterIndex >= 0)
+        {
+            mCallback->invoke(&frame, frame.filterIndex);
+            log_d("Frame 0x%X processed by filter %d", message.identifier, frame.filterIndex);
+        }
+        else
+        {
+            // Обработка кадров, не прошедших фильтрацию
+            mCallback->invoke(&frame);
+            log_d("Frame 0x%X received (no filter)", message.identifier);
+        }
+    }
+
+    bool Can::transmit(const CanFrame& frame, const TickType_t timeout)
+    {
+        twai_message_t message;
+        message.identifier = frame.id;
+        message.data_length_code = frame.length;
+        message.rtr = frame.rtr;
+        message.extd = frame.extended;
+        memcpy(message.data, frame.data.bytes, CAN_FRAME_DATA_SIZE);
+
+        // Счетчик и CRC рассчитываются непосредственно перед передачей
+        const int8_t profile = frame.e2eProfile;
+        bool e2e = false;
+        uint8_t counter = 0;
+        if (profile >= 0 && profile < CAN_NUM_E2E_PROFILE)
+        {
+            portENTER_CRITICAL(&mTxLock);
+            counter = mE2ECounters[profile];
+            mE2ECounters[profile] = (counter + 1) & CAN_E2E_COUNTER_MASK;
+            portEXIT_CRITICAL(&mTxLock);
+
+            e2e = CanE2E::protect(mE2EProfiles[profile], message.data, frame.length, counter);
+            if (!e2e) releaseE2ECounter(profile, counter);
+        }
+
+        // Попытка учитывается до постановки, чтобы sendWhenIdle() видел кадры, поставленные параллельно
+        mTxAttempts++;
+        const esp_err_t err = twai_transmit(&message, timeout);
+        if (err != ESP_OK)
+        {
+            // Значение счетчика расходуется только кадром, принятым драйвером
+            if (e2e) releaseE2ECounter(profile, counter);
+            log_w("Failed to send frame 0x%X: %d", frame.id, err);
+            return false;
+        }
+
+        log_d("Frame 0x%X sent successfully", frame.id);
+        return true;
+    }
+
+    void Can::releaseE2ECounter(const int8_t profile, const uint8_t counter)
+    {
+        // Если значение уже занял другой кадр, получатель увидит пропуск, а не повтор счетчика
+        portENTER_CRITICAL(&mTxLock);
+        if (mE2ECounters[profile] == ((counter + 1) & CAN_E2E_COUNTER_MASK)) mE2ECounters[profile] = counter;
+        portEXIT_CRITICAL(&mTxLock);
+    }
+
+    void Can::accountShaper(const CanFrame& frame)
+    {
+        portENTER_CRITICAL(&mTxLock);
+        mShaper.account(frame);
+        portEXIT_CRITICAL(&mTxLock);
+    }
+
+    void Can::transmitPending()
+    {
+        CanFrame frame;
+        while (true)
+        {
+            portENTER_CRITICAL(&mTxLock);
+            const bool pending = mShaper.takePending(frame);
+            portEXIT_CRITICAL(&mTxLock);
+            if (!pending) break;
+
+            (void)transmit(frame, pdMS_TO_TICKS(CAN_SEND_MS_TO_TICKS));
+        }
     }
 
-    bool Can::send(CanFrame& frame) const
+    bool Can::send(CanFrame& frame)
     {
         if (!frame.hasData())
         {
@@ -268,6 +562,8 @@ namespace canbus
         bool result = false;
         if (mDriverReady && mStatusInfo.state == TWAI_STATE_RUNNING)
         {
+            transmitPending();
+
             const unsigned long currentTime = millis();
             if (frame.nextSendTime <= currentTime)
             {
@@ -276,22 +572,34 @@ namespace canbus
                     frame.nextSendTime = currentTime + frame.frequency;
                 }
 
-                twai_message_t message;
-                message.identifier = frame.id;
-                message.data_length_code = frame.length;
-                message.rtr = frame.rtr;
-                message.extd = frame.extended;
-                memcpy(message.data, frame.data.bytes, CAN_FRAME_DATA_SIZE);
-
-                const esp_err_t err = twai_transmit(&message, pdMS_TO_TICKS(CAN_SEND_MS_TO_TICKS));
-                if (err == ESP_OK)
+                // Семафор освобождается на время задержки, чтобы не блокировать остальных отправителей
+                unsigned long waited = 0;
+                CanShapeResult shape;
+                while (true)
                 {
-                    log_d("Frame 0x%X sent successfully", frame.id);
-                    result = true;
+                    portENTER_CRITICAL(&mTxLock);
+                    shape = mShaper.admit(frame, waited);
+                    portEXIT_CRITICAL(&mTxLock);
+                    if (shape != CanShapeResult::DELAY) break;
+
+                    (void)mSemaphore.give();
+                    vTaskDelay(pdMS_TO_TICKS(1));
+                    waited++;
+                    if (!mSemaphore.take()) return false;
+                    if (!mDriverReady) break;
                 }
-                else
+
+                switch (shape)
                 {
-                    log_w("Failed to send frame 0x%X: %d", frame.id, err);
+                case CanShapeResult::SEND: result = transmit(frame, pdMS_TO_TICKS(CAN_SEND_MS_TO_TICKS));
+                    break;
+                case CanShapeResult::COALESCED: log_d("Frame 0x%X coalesced", frame.id);
+                    result = true;
+                    break;
+                case CanShapeResult::DELAY: log_w("CAN interface stopped while frame 0x%X delayed", frame.id);
+                    break;
+                default: log_w("Frame 0x%X dropped by shaper", frame.id);
+                    break;
                 }
             }
             else
@@ -308,12 +616,154 @@ namespace canbus
         return result;
     }
 
+    bool Can::sendWhenIdle(const CanFrame& frame, const unsigned long timeout)
+    {
+        if (!mDriverReady || mStatusInfo.state != TWAI_STATE_RUNNING)
+        {
+            log_w("CAN interface not ready");
+            return false;
+        }
+
+        // Освобождение очереди ожидается без семафора, остальные отправители не блокируются
+        const unsigned long stopTime = millis() + timeout;
+        twai_status_info_t status = {};
+        while (twai_get_status_info(&status) == ESP_OK)
+        {
+            if (status.msgs_to_tx == 0 && mSemaphore.take(pdMS_TO_TICKS(CAN_SEND_MS_TO_TICKS)))
+            {
+                // Под семафором кадры ставит только задача приема, ее попытки видны по счетчику
+                const uint32_t attempts = mTxAttempts;
+                const bool idle = twai_get_status_info(&status) == ESP_OK && status.msgs_to_tx == 0;
+                bool result = false;
+                if (idle)
+                {
+                    uint32_t alerts = 0;
+                    while (twai_read_alerts(&alerts, 0) == ESP_OK)
+                    {
+                    }
+                    result = transmit(frame, 0);
+                }
+                (void)mSemaphore.give();
+
+                if (idle)
+                {
+                    if (!result) return false;
+
+                    accountShaper(frame);
+                    if (mTxAttempts != attempts + 1)
+                    {
+                        log_w("Frame queued together with 0x%X, TX completion is ambiguous", frame.id);
+                        return false;
+                    }
+                    return true;
+                }
+            }
+
+            if (millis() >= stopTime) break;
+            vTaskDelay(pdMS_TO_TICKS(1));
+        }
+
+        log_w("TX queue busy, frame 0x%X not sent", frame.id);
+        return false;
+    }
+
+    void Can::setShaperRule(const uint8_t index, const CanShaperRule& rule)
+    {
+        if (!mSemaphore.take()) return;
+
+        portENTER_CRITICAL(&mTxLock);
+        const bool result = mShaper.setRule(index, rule);
+        portEXIT_CRITICAL(&mTxLock);
+        if (result) log_d("Shaper rule %d set: id=0x%X, mask=0x%X, rate=%u", index, rule.id, rule.mask, rule.rate);
+
+        (void)mSemaphore.give();
+    }
+
+    void Can::clearShaperRules()
+    {
+        if (!mSemaphore.take()) return;
+
+        portENTER_CRITICAL(&mTxLock);
+        mShaper.clearRules();
+        portEXIT_CRITICAL(&mTxLock);
+        log_i("All shaper rules cleared");
+
+        (void)mSemaphore.give();
+    }
+
+    void Can::setBusLoadBudget(const uint8_t percent, const CanShapePolicy policy)
+    {
+        if (!mSemaphore.take()) return;
+
+        portENTER_CRITICAL(&mTxLock);
+        mShaper.setBudget(percent, policy);
+        portEXIT_CRITICAL(&mTxLock);
+        log_i("Bus load budget set to %u%% of %u bit/s", percent > 100 ? 100 : percent, getBitrate(mSpeed));
+
+        (void)mSemaphore.give();
+    }
+
+    CanShaperStats Can::getShaperStats() const
+    {
+        portENTER_CRITICAL(&mTxLock);
+        const CanShaperStats stats = mShaper.getStats();
+        portEXIT_CRITICAL(&mTxLock);
+        return stats;
+    }
+
+    int Can::setRtrResponse(const CanFrame& frame)
+    {
+        const int index = mRtrResponder.set(frame);
+        if (index >= 0) log_d("RTR response %d set: id=0x%X", index, frame.id);
+        return index;
+    }
+
+    bool Can::updateRtrResponse(const uint32_t id, const bool extended, const uint8_t* data, const uint8_t length)
+    {
+        return mRtrResponder.update(id, extended, data, length);
+    }
+
+    void Can::removeRtrResponse(const uint32_t id, const bool extended)
+    {
+        mRtrResponder.remove(id, extended);
+    }
+
+    void Can::clearRtrResponses()
+    {
+        mRtrResponder.clear();
+        log_i("All RTR responses cleared");
+    }
+
+    CanRtrStats Can::getRtrStats() const
+    {
+        return mRtrResponder.getStats();
+    }
+
+    void Can::setTimeSync(CanTimeSync* timeSync)
+    {
+        if (!mTimeSyncSemaphore.take()) return;
+
+        mTimeSync = timeSync;
+
+        (void)mTimeSyncSemaphore.give();
+    }
+
+    int64_t Can::getTime() const
+    {
+        if (!mTimeSyncSemaphore.take()) return esp_timer_get_time();
+
+        const int64_t result = mTimeSync != nullptr ? mTimeSync->getTime() : esp_timer_get_time();
+
+        (void)mTimeSyncSemaphore.give();
+        return result;
+    }
+
     bool Can::receive(CanFrame& frame) const
     {
         return mCallback != nullptr && mCallback->read(&frame);
     }
 
-    void Can::handleWatchdog()
+    uint32_t Can::handleWatchdog()
     {
         if (twai_get_status_info(&mStatusInfo) == ESP_OK &&
             mStatusInfo.state == TWAI_STATE_BUS_OFF)
@@ -323,16 +773,35 @@ namespace canbus
                 log_w("Bus recovery failed");
             }
         }
+
+        // Отложенные (объединенные) кадры отправляются и при отсутствии новых вызовов send(),
+        // следующая проверка планируется на момент появления ресурса для ближайшего из них
+        uint32_t delay = CAN_WATCHDOG_MS;
+        if (mDriverReady && mStatusInfo.state == TWAI_STATE_RUNNING && mSemaphore.take())
+        {
+            transmitPending();
+            portENTER_CRITICAL(&mTxLock);
+            const uint32_t wait = mShaper.getPendingWait();
+            portEXIT_CRITICAL(&mTxLock);
+            (void)mSemaphore.give();
+
+            if (wait != UINT32_MAX)
+            {
+                const uint32_t waitMs = wait / 1000 + 1;
+                if (waitMs < delay) delay = waitMs;
+            }
+        }
+        return delay;
     }
 
-    bool Can::handleReceive() const
+    bool Can::handleReceive()
     {
         if (!mDriverReady) return false;
 
         twai_message_t message;
         if (twai_receive(&message, pdMS_TO_TICKS(CAN_RECEIVE_MS_TO_TICKS)) == ESP_OK)
         {
-            processFrame(message);
+            processFrame(message, esp_timer_get_time());
         }
         return true;
     }
@@ -340,7 +809,7 @@ namespace canbus
     void Can::onResponse(void* value, void* params)
     {
         auto* frame = static_cast<CanFrame*>(value);
-        const auto* can = static_cast<Can*>(params);
+        auto* can = static_cast<Can*>(params);
         can->send(*frame);
     }
 } // namespace hardware
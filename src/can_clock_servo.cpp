@@ -0,0 +1,105 @@
+#include "canbus/can_clock_servo.h"
+
+namespace canbus
+{
+    void CanClockServo::reset()
+    {
+        mHasAnchor = false;
+        mSamples = 0;
+        mAnchorLocal = 0;
+        mAnchorShared = 0;
+        mLastMaster = 0;
+        mDriftPpb = 0;
+        mSlewPpb = 0;
+        mSlewDuration = 0;
+        mLastError = 0;
+    }
+
+    void CanClockServo::sample(const int64_t masterTime, const int64_t localTime)
+    {
+        const int64_t interval = localTime - mAnchorLocal;
+        if (!mHasAnchor || interval <= 0)
+        {
+            mHasAnchor = true;
+            mSamples = 1;
+            mSlewPpb = 0;
+            mSlewDuration = 0;
+            mAnchorLocal = localTime;
+            mAnchorShared = masterTime;
+            mLastMaster = masterTime;
+            mLastError = 0;
+            return;
+        }
+
+        const int64_t predicted = toShared(localTime);
+        const int64_t error = masterTime - predicted;
+        const int64_t threshold = stepThreshold(interval);
+        mLastError = error;
+
+        if (mSamples < 2 || error > threshold || error < -threshold)
+        {
+            // Частота оценивается по интервалу между двумя отсчетами, фаза - скачком на время ведущего.
+            // Неправдоподобная оценка (скачок времени ведущего) не заменяет прежнюю
+            const int64_t deviation = (masterTime - mLastMaster) - interval;
+            const int64_t maxDeviation = interval * CAN_SERVO_MAX_DRIFT_PPB / 1000000000LL;
+            const bool valid = deviation <= maxDeviation && deviation >= -maxDeviation;
+            if (valid) mDriftPpb = static_cast<int32_t>(deviation * 1000000000LL / interval);
+            mSamples = valid ? 2 : 1;
+            mSlewPpb = 0;
+            mSlewDuration = 0;
+            mAnchorLocal = localTime;
+            mAnchorShared = masterTime;
+            mLastMaster = masterTime;
+            return;
+        }
+
+        // Дрейф корректируется на долю относительной ошибки за интервал
+        int64_t drift = mDriftPpb + (error * 1000000000LL / interval) / (1 << CAN_SERVO_DRIFT_SHIFT);
+        if (drift > CAN_SERVO_MAX_DRIFT_PPB) drift = CAN_SERVO_MAX_DRIFT_PPB;
+        if (drift < -CAN_SERVO_MAX_DRIFT_PPB) drift = -CAN_SERVO_MAX_DRIFT_PPB;
+        mDriftPpb = static_cast<int32_t>(drift);
+
+        // Опорная точка остается на прогнозе (шкала непрерывна), доля ошибки фазы отрабатывается
+        // скоростью в течение следующего интервала, поэтому время не идет назад
+        int64_t slew = (error / (1 << CAN_SERVO_PHASE_SHIFT)) * 1000000000LL / interval;
+        if (slew > CAN_SERVO_MAX_SLEW_PPB) slew = CAN_SERVO_MAX_SLEW_PPB;
+        if (slew < -CAN_SERVO_MAX_SLEW_PPB) slew = -CAN_SERVO_MAX_SLEW_PPB;
+        mSlewPpb = static_cast<int32_t>(slew);
+        mSlewDuration = interval;
+
+        mAnchorLocal = localTime;
+        mAnchorShared = predicted;
+        mLastMaster = masterTime;
+        if (mSamples < CAN_SERVO_LOCK_SAMPLES) mSamples++;
+    }
+
+    int64_t CanClockServo::toShared(const int64_t localTime) const
+    {
+        if (!mHasAnchor) return localTime;
+
+        const int64_t elapsed = localTime - mAnchorLocal;
+        const int64_t slewed = elapsed < mSlewDuration ? elapsed : mSlewDuration;
+        // Одно деление: суммарная поправка меньше 1 мкс на 1 мкс, поэтому результат не убывает
+        return mAnchorShared + elapsed + (elapsed * mDriftPpb + slewed * mSlewPpb) / 1000000000LL;
+    }
+
+    bool CanClockServo::isLocked() const
+    {
+        return mSamples >= CAN_SERVO_LOCK_SAMPLES;
+    }
+
+    int64_t CanClockServo::getLastError() const
+    {
+        return mLastError;
+    }
+
+    int32_t CanClockServo::getDrift() const
+    {
+        return mDriftPpb;
+    }
+
+    int64_t CanClockServo::stepThreshold(const int64_t interval)
+    {
+        return CAN_SERVO_STEP_THRESHOLD_US + interval * CAN_SERVO_MAX_DRIFT_PPB / 1000000000LL;
+    }
+} // namespace hardware
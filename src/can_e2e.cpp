@@ -0,0 +1,116 @@
+#include "canbus/can_e2e.h"
+
+namespace canbus
+{
+    namespace
+    {
+        /**
+         * @brief Таблица CRC8, вычисляемая на этапе компиляции
+         */
+        struct Crc8Table
+        {
+            uint8_t values[256] = {};
+
+            constexpr explicit Crc8Table(const uint8_t polynomial)
+            {
+                for (int i = 0; i < 256; i++)
+                {
+                    auto crc = static_cast<uint8_t>(i);
+                    for (int bit = 0; bit < 8; bit++)
+                    {
+                        crc = (crc & 0x80) ? static_cast<uint8_t>((crc << 1) ^ polynomial)
+                                           : static_cast<uint8_t>(crc << 1);
+                    }
+                    values[i] = crc;
+                }
+            }
+        };
+
+        constexpr Crc8Table CRC8_SAE_J1850(0x1D);
+        constexpr Crc8Table CRC8_H2F(0x2F);
+        constexpr uint8_t CRC8_START_VALUE = 0xFF;
+        constexpr uint8_t CRC8_XOR_VALUE = 0xFF;
+    } // namespace
+
+    bool CanE2E::isValid(const CanE2EProfile& profile)
+    {
+        // Совпадающие позиции затирают счетчик CRC, другой сдвиг обрезает маску счетчика
+        return profile.crcByte < CAN_E2E_MAX_LENGTH && profile.counterByte < CAN_E2E_MAX_LENGTH &&
+            profile.crcByte != profile.counterByte && (profile.counterShift == 0 || profile.counterShift == 4);
+    }
+
+    uint8_t CanE2E::calculateCrc(const CanE2EProfile& profile, const uint8_t* data, const uint8_t length)
+    {
+        const uint8_t* table = profile.crc == CanE2ECrc::CRC8H2F ? CRC8_H2F.values : CRC8_SAE_J1850.values;
+
+        uint8_t crc = CRC8_START_VALUE;
+        crc = table[crc ^ static_cast<uint8_t>(profile.dataId)];
+        crc = table[crc ^ static_cast<uint8_t>(profile.dataId >> 8)];
+        for (uint8_t i = 0; i < length; i++)
+        {
+            if (i != profile.crcByte) crc = table[crc ^ data[i]];
+        }
+        return crc ^ CRC8_XOR_VALUE;
+    }
+
+    bool CanE2E::protect(const CanE2EProfile& profile, uint8_t* data, const uint8_t length, const uint8_t counter)
+    {
+        if (!profile.configured || profile.crcByte >= length || profile.counterByte >= length) return false;
+
+        const auto mask = static_cast<uint8_t>(CAN_E2E_COUNTER_MASK << profile.counterShift);
+        data[profile.counterByte] = (data[profile.counterByte] & ~mask) |
+            ((counter << profile.counterShift) & mask);
+        data[profile.crcByte] = calculateCrc(profile, data, length);
+        return true;
+    }
+
+    CanE2EStatus CanE2E::check(const CanE2EProfile& profile,
+                               const uint8_t* data,
+                               const uint8_t length,
+                               CanE2EState& state)
+    {
+        if (!profile.configured) return CanE2EStatus::NONE;
+
+        if (profile.crcByte >= length || profile.counterByte >= length ||
+            data[profile.crcByte] != calculateCrc(profile, data, length))
+        {
+            state.crcErrors++;
+            return CanE2EStatus::WRONG_CRC;
+        }
+
+        const uint8_t counter = (data[profile.counterByte] >> profile.counterShift) & CAN_E2E_COUNTER_MASK;
+        if (!state.initialized)
+        {
+            state.initialized = true;
+            state.lastCounter = counter;
+            state.okCount++;
+            return CanE2EStatus::OK;
+        }
+
+        const uint8_t delta = (counter - state.lastCounter) & CAN_E2E_COUNTER_MASK;
+        if (delta == 0)
+        {
+            state.repeated++;
+            return CanE2EStatus::REPEATED;
+        }
+
+        // Счетчик ресинхронизируется и при недопустимом скачке, чтобы не терять последующие кадры
+        state.lastCounter = counter;
+        state.lostFrames += delta - 1;
+        if (delta > profile.maxDeltaCounter)
+        {
+            state.sequenceErrors++;
+            return CanE2EStatus::WRONG_SEQUENCE;
+        }
+
+        state.okCount++;
+        return delta > 1 ? CanE2EStatus::OK_SOME_LOST : CanE2EStatus::OK;
+    }
+
+    bool CanE2E::isError(const CanE2EStatus status)
+    {
+        return status == CanE2EStatus::WRONG_CRC ||
+            status == CanE2EStatus::REPEATED ||
+            status == CanE2EStatus::WRONG_SEQUENCE;
+    }
+} // namespace hardware
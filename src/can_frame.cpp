@@ -17,6 +17,8 @@ namespace canbus
         extended = 0;
         rtr = 0;
         filterIndex = -1;
+        e2eStatus = CanE2EStatus::NONE;
+        timestamp = 0;
         memset(&data, 0, sizeof(data));
         log_d("CAN frame cleared");
     }
@@ -0,0 +1,87 @@
+#include "canbus/can_frame_pool.h"
+#include "canbus/can_subscriber.h"
+#include <esp32-hal-log.h>
+
+namespace canbus
+{
+    CanPoolFrame* CanFramePool::acquire()
+    {
+        for (auto& item : mFrames)
+        {
+            uint8_t expected = 0;
+            if (item.refs.compare_exchange_strong(expected, 1))
+            {
+                return &item;
+            }
+        }
+        log_w("Frame pool exhausted");
+        return nullptr;
+    }
+
+    uint8_t CanFramePool::available() const
+    {
+        uint8_t result = 0;
+        for (const auto& item : mFrames)
+        {
+            if (item.refs.load() == 0) result++;
+        }
+        return result;
+    }
+
+    void CanFramePool::retain(CanPoolFrame* frame)
+    {
+        if (frame != nullptr) frame->refs.fetch_add(1);
+    }
+
+    void CanFramePool::release(CanPoolFrame* frame)
+    {
+        if (frame != nullptr) frame->refs.fetch_sub(1);
+    }
+
+    CanFrameRef::~CanFrameRef()
+    {
+        reset();
+    }
+
+    CanFrameRef::CanFrameRef(CanFrameRef&& other) noexcept : mFrame(other.mFrame), mOwner(other.mOwner)
+    {
+        other.mFrame = nullptr;
+        other.mOwner = nullptr;
+    }
+
+    CanFrameRef& CanFrameRef::operator=(CanFrameRef&& other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            mFrame = other.mFrame;
+            mOwner = other.mOwner;
+            other.mFrame = nullptr;
+            other.mOwner = nullptr;
+        }
+        return *this;
+    }
+
+    void CanFrameRef::reset()
+    {
+        if (mFrame == nullptr) return;
+
+        // Кадр возвращается в пул раньше резерва, чтобы занятых кадров не стало больше резерва
+        CanFramePool::release(mFrame);
+        if (mOwner != nullptr) mOwner->releaseRef();
+        mFrame = nullptr;
+        mOwner = nullptr;
+    }
+
+    const CanFrame* CanFrameRef::get() const
+    {
+        return mFrame != nullptr ? &mFrame->frame : nullptr;
+    }
+
+    void CanFrameRef::attach(CanPoolFrame* frame, CanSubscriber* owner)
+    {
+        reset();
+        mFrame = frame;
+        mOwner = owner;
+    }
+} // namespace hardware
@@ -0,0 +1,115 @@
+#include "canbus/can_rtr_responder.h"
+#include <esp32-hal-log.h>
+
+namespace canbus
+{
+    int CanRtrResponder::set(const CanFrame& frame)
+    {
+        if (frame.length > CAN_FRAME_DATA_SIZE) return -1;
+
+        portENTER_CRITICAL(&mLock);
+        int index = find(frame.id, frame.extended != 0);
+        if (index < 0)
+        {
+            for (int i = 0; i < CAN_NUM_RTR_RESPONDER; i++)
+            {
+                if (!mUsed[i])
+                {
+                    index = i;
+                    break;
+                }
+            }
+        }
+        if (index >= 0)
+        {
+            mFrames[index] = frame;
+            mFrames[index].rtr = 0;
+            mUsed[index] = true;
+        }
+        portEXIT_CRITICAL(&mLock);
+
+        if (index < 0) log_w("No free RTR responder entries available");
+        return index;
+    }
+
+    bool CanRtrResponder::update(const uint32_t id, const bool extended, const uint8_t* data, const uint8_t length)
+    {
+        if (data == nullptr || length > CAN_FRAME_DATA_SIZE) return false;
+
+        portENTER_CRITICAL(&mLock);
+        const int index = find(id, extended);
+        if (index >= 0)
+        {
+            memcpy(mFrames[index].data.bytes, data, length);
+            mFrames[index].length = length;
+        }
+        portEXIT_CRITICAL(&mLock);
+        return index >= 0;
+    }
+
+    void CanRtrResponder::remove(const uint32_t id, const bool extended)
+    {
+        portENTER_CRITICAL(&mLock);
+        const int index = find(id, extended);
+        if (index >= 0) mUsed[index] = false;
+        portEXIT_CRITICAL(&mLock);
+    }
+
+    void CanRtrResponder::clear()
+    {
+        portENTER_CRITICAL(&mLock);
+        for (auto& used : mUsed)
+        {
+            used = false;
+        }
+        portEXIT_CRITICAL(&mLock);
+    }
+
+    bool CanRtrResponder::prepare(const uint32_t id, const bool extended, CanFrame& frame)
+    {
+        portENTER_CRITICAL(&mLock);
+        const int index = find(id, extended);
+        if (index >= 0)
+        {
+            frame = mFrames[index];
+            mStats.requests++;
+        }
+        portEXIT_CRITICAL(&mLock);
+        return index >= 0;
+    }
+
+    void CanRtrResponder::account(const bool sent, const uint32_t queueUs)
+    {
+        portENTER_CRITICAL(&mLock);
+        if (sent)
+        {
+            mStats.responses++;
+            mStats.lastQueueUs = queueUs;
+            if (queueUs > mStats.maxQueueUs) mStats.maxQueueUs = queueUs;
+            mTotalQueueUs += queueUs;
+            mStats.avgQueueUs = static_cast<uint32_t>(mTotalQueueUs / mStats.responses);
+        }
+        else
+        {
+            mStats.failures++;
+        }
+        portEXIT_CRITICAL(&mLock);
+    }
+
+    CanRtrStats CanRtrResponder::getStats() const
+    {
+        portENTER_CRITICAL(&mLock);
+        const CanRtrStats stats = mStats;
+        portEXIT_CRITICAL(&mLock);
+        return stats;
+    }
+
+    int CanRtrResponder::find(const uint32_t id, const bool extended) const
+    {
+        for (int i = 0; i < CAN_NUM_RTR_RESPONDER; i++)
+        {
+            if (mUsed[i] && mFrames[i].id == id && (mFrames[i].extended != 0) == extended) return i;
+        }
+        return -1;
+    }
+} // namespace hardware
@@ -0,0 +1,288 @@
+#include "canbus/can_shaper.h"
+
+namespace canbus
+{
+    namespace
+    {
+        constexpr uint32_t CAN_STUFF_BITS_STANDARD = 34; ///< Поля с bit stuffing (11 бит, без данных)
+        constexpr uint32_t CAN_STUFF_BITS_EXTENDED = 54; ///< Поля с bit stuffing (29 бит, без данных)
+        constexpr uint32_t CAN_TAIL_BITS = 13;           ///< CRC delimiter, ACK, EOF и межкадровый интервал
+    } // namespace
+
+    uint32_t CanShaper::frameBits(const CanFrame& frame)
+    {
+        const uint32_t dataBits = frame.rtr ? 0 : 8 * min<uint32_t>(frame.length, CAN_FRAME_DATA_SIZE);
+        const uint32_t stuffed = (frame.extended ? CAN_STUFF_BITS_EXTENDED : CAN_STUFF_BITS_STANDARD) + dataBits;
+        return stuffed + (stuffed - 1) / 4 + CAN_TAIL_BITS;
+    }
+
+    void CanShaper::setBitrate(const uint32_t bitrate)
+    {
+        mBitrate = bitrate;
+        setBudget(mBudgetPercent, mBudgetPolicy);
+    }
+
+    void CanShaper::setBudget(const uint8_t percent, const CanShapePolicy policy)
+    {
+        mBudgetPercent = percent > 100 ? 100 : percent;
+        mBudgetPolicy = policy;
+        mBudgetBits = static_cast<uint64_t>(mBitrate) * mBudgetPercent * CAN_SHAPER_WINDOW_MS / 100000;
+        mBudgetTime = micros();
+        mStats.budgetPercent = mBudgetPercent;
+    }
+
+    bool CanShaper::setRule(const uint8_t index, const CanShaperRule& rule)
+    {
+        if (index >= CAN_NUM_SHAPER_RULE) return false;
+
+        mRules[index] = rule;
+        mRules[index].configured = true;
+        mRules[index].id = rule.id & rule.mask;
+        if (mRules[index].burst == 0) mRules[index].burst = 1;
+
+        auto& state = mStates[index];
+        state.credit = ruleCost(mRules[index]) * mRules[index].burst;
+        state.lastTime = micros();
+        clearPending(index);
+        return true;
+    }
+
+    CanShaperRule CanShaper::getRule(const int8_t index) const
+    {
+        return (index >= 0 && index < CAN_NUM_SHAPER_RULE) ? mRules[index] : CanShaperRule{};
+    }
+
+    void CanShaper::clearRules()
+    {
+        for (auto& rule : mRules)
+        {
+            rule = CanShaperRule{};
+        }
+        for (auto& pending : mPending)
+        {
+            if (pending.rule >= 0) pending.used = false;
+        }
+    }
+
+    CanShapeResult CanShaper::admit(const CanFrame& frame, const unsigned long waited)
+    {
+        refill(micros());
+
+        const uint32_t bits = frameBits(frame);
+        const int ruleIndex = findRule(frame);
+        const bool ruleOk = ruleIndex < 0 || mRules[ruleIndex].rate == 0 ||
+            mStates[ruleIndex].credit >= ruleCost(mRules[ruleIndex]);
+        const bool budgetOk = mBudgetPercent >= 100 || mBudgetBits >= bits;
+
+        if (ruleOk && budgetOk)
+        {
+            consume(ruleIndex, bits);
+            // Более новые данные того же ID вытесняют отложенный кадр
+            if (const int pending = findPending(frame); pending >= 0)
+            {
+                mPending[pending].used = false;
+                mStats.superseded++;
+            }
+            mStats.sent++;
+            return CanShapeResult::SEND;
+        }
+
+        const CanShapePolicy policy = ruleIndex >= 0 ? mRules[ruleIndex].policy : mBudgetPolicy;
+        if (policy == CanShapePolicy::DELAY && waited < CAN_SHAPER_MAX_DELAY_MS)
+        {
+            if (waited == 0) mStats.delayed++;
+            return CanShapeResult::DELAY;
+        }
+
+        if (policy == CanShapePolicy::COALESCE)
+        {
+            // Отложенный кадр хранится отдельно для каждого ID (диапазона правила или вне правил)
+            int pending = findPending(frame);
+            if (pending >= 0)
+            {
+                mStats.superseded++;
+            }
+            else
+            {
+                for (int i = 0; i < CAN_SHAPER_NUM_PENDING; i++)
+                {
+                    if (!mPending[i].used)
+                    {
+                        pending = i;
+                        break;
+                    }
+                }
+            }
+
+            if (pending >= 0)
+            {
+                auto& item = mPending[pending];
+                item.used = true;
+                item.rule = static_cast<int8_t>(ruleIndex);
+                item.frame = frame;
+                mStats.coalesced++;
+                return CanShapeResult::COALESCED;
+            }
+        }
+
+        mStats.dropped++;
+        return CanShapeResult::DROP;
+    }
+
+    void CanShaper::account(const CanFrame& frame)
+    {
+        refill(micros());
+        consume(-1, frameBits(frame));
+    }
+
+    uint32_t CanShaper::getPendingWait()
+    {
+        refill(micros());
+
+        uint32_t result = UINT32_MAX;
+        for (const auto& pending : mPending)
+        {
+            if (!pending.used) continue;
+
+            uint32_t wait = 0;
+            if (pending.rule >= 0)
+            {
+                const uint32_t cost = ruleCost(mRules[pending.rule]);
+                const uint32_t credit = mStates[pending.rule].credit;
+                if (credit < cost) wait = cost - credit;
+            }
+
+            const uint32_t bits = frameBits(pending.frame);
+            if (mBudgetPercent < 100 && mBudgetBits < bits)
+            {
+                // Бюджет пополняется со скоростью bitrate * percent / 100 бит/с
+                const uint64_t rate = static_cast<uint64_t>(mBitrate) * mBudgetPercent;
+                const uint64_t budgetWait = rate > 0 ? (bits - mBudgetBits) * 100000000ULL / rate + 1 : UINT32_MAX;
+                if (budgetWait > wait) wait = budgetWait < UINT32_MAX ? static_cast<uint32_t>(budgetWait) : UINT32_MAX;
+            }
+
+            if (wait < result) result = wait;
+        }
+        return result;
+    }
+
+    bool CanShaper::takePending(CanFrame& frame)
+    {
+        refill(micros());
+
+        for (auto& pending : mPending)
+        {
+            if (!pending.used) continue;
+
+            const uint32_t bits = frameBits(pending.frame);
+            if ((pending.rule < 0 || mStates[pending.rule].credit >= ruleCost(mRules[pending.rule])) &&
+                (mBudgetPercent >= 100 || mBudgetBits >= bits))
+            {
+                consume(pending.rule, bits);
+                pending.used = false;
+                frame = pending.frame;
+                mStats.sent++;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    CanShaperStats CanShaper::getStats() const
+    {
+        CanShaperStats stats = mStats;
+        stats.budgetBits = mBudgetBits;
+        return stats;
+    }
+
+    void CanShaper::refill(const unsigned long now)
+    {
+        for (int i = 0; i < CAN_NUM_SHAPER_RULE; i++)
+        {
+            const auto& rule = mRules[i];
+            auto& state = mStates[i];
+            if (!rule.configured || rule.rate == 0) continue;
+
+            const uint32_t capacity = ruleCost(rule) * rule.burst;
+            const uint32_t elapsed = now - state.lastTime;
+            state.credit = (capacity - state.credit > elapsed) ? state.credit + elapsed : capacity;
+            state.lastTime = now;
+        }
+
+        if (mBudgetPercent < 100)
+        {
+            const uint32_t capacity = static_cast<uint64_t>(mBitrate) * mBudgetPercent * CAN_SHAPER_WINDOW_MS / 100000;
+            const uint32_t added = static_cast<uint64_t>(now - mBudgetTime) * mBitrate * mBudgetPercent / 100000000;
+            // Время не сдвигается, пока не накоплен хотя бы один бит
+            if (added > 0)
+            {
+                mBudgetBits = (capacity - mBudgetBits > added) ? mBudgetBits + added : capacity;
+                mBudgetTime = now;
+            }
+        }
+
+        const unsigned long window = now - mWindowStart;
+        if (window >= CAN_SHAPER_WINDOW_MS * 1000UL)
+        {
+            const uint64_t windowCapacity = static_cast<uint64_t>(mBitrate) * window / 1000000;
+            mStats.loadPercent = windowCapacity > 0 ? min<uint64_t>(mWindowBits * 100ULL / windowCapacity, 100) : 0;
+            mWindowBits = 0;
+            mWindowStart = now;
+        }
+    }
+
+    int CanShaper::findRule(const CanFrame& frame) const
+    {
+        for (int i = 0; i < CAN_NUM_SHAPER_RULE; i++)
+        {
+            const auto& rule = mRules[i];
+            if (rule.configured && (frame.id & rule.mask) == rule.id && (frame.extended != 0) == rule.extended)
+            {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    int CanShaper::findPending(const CanFrame& frame) const
+    {
+        for (int i = 0; i < CAN_SHAPER_NUM_PENDING; i++)
+        {
+            const auto& pending = mPending[i];
+            if (pending.used && pending.frame.id == frame.id && pending.frame.extended == frame.extended)
+            {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    void CanShaper::clearPending(const int ruleIndex)
+    {
+        for (auto& pending : mPending)
+        {
+            if (pending.rule == ruleIndex) pending.used = false;
+        }
+    }
+
+    uint32_t CanShaper::ruleCost(const CanShaperRule& rule)
+    {
+        return rule.rate > 0 ? 1000000UL / rule.rate : 0;
+    }
+
+    void CanShaper::consume(const int ruleIndex, const uint32_t bits)
+    {
+        if (ruleIndex >= 0)
+        {
+            auto& state = mStates[ruleIndex];
+            const uint32_t cost = ruleCost(mRules[ruleIndex]);
+            state.credit = state.credit > cost ? state.credit - cost : 0;
+        }
+
+        if (mBudgetPercent < 100)
+        {
+            mBudgetBits = mBudgetBits > bits ? mBudgetBits - bits : 0;
+        }
+        mWindowBits += bits;
+    }
+} // namespace hardware
@@ -0,0 +1,149 @@
+#include "canbus/can_subscriber.h"
+#include "canbus/can.h"
+#include <esp32-hal-log.h>
+
+namespace canbus
+{
+    CanSubscriber::CanSubscriber(const uint8_t queueSize, const CanOverflowPolicy policy)
+        : mQueueSize(queueSize > 0 ? queueSize : 1),
+          mPolicy(policy)
+    {
+        mQueue = xQueueCreate(mQueueSize, sizeof(CanPoolFrame*));
+        if (mQueue == nullptr)
+        {
+            log_e("Failed to create subscriber queue");
+        }
+    }
+
+    CanSubscriber::~CanSubscriber()
+    {
+        // После отключения задача приема больше не обращается к подписчику
+        if (mCan != nullptr) mCan->unsubscribe(this);
+        if (mQueue == nullptr) return;
+
+        CanPoolFrame* frame = nullptr;
+        while (xQueueReceive(mQueue, &frame, 0) == pdTRUE)
+        {
+            CanFramePool::release(frame);
+        }
+        vQueueDelete(mQueue);
+    }
+
+    int CanSubscriber::addFilter(const uint32_t id, const uint32_t mask, const bool extended)
+    {
+        if (mNumFilters >= CAN_SUBSCRIBER_NUM_FILTER)
+        {
+            log_w("No free subscriber filters available");
+            return -1;
+        }
+
+        auto& filter = mFilters[mNumFilters];
+        filter.extended = extended;
+        filter.id = id & mask;
+        filter.mask = mask;
+        return mNumFilters++;
+    }
+
+    void CanSubscriber::clearFilters()
+    {
+        mNumFilters = 0;
+    }
+
+    bool CanSubscriber::matches(const CanFrame& frame) const
+    {
+        if (mNumFilters == 0) return true;
+
+        for (uint8_t i = 0; i < mNumFilters; i++)
+        {
+            const auto& filter = mFilters[i];
+            if ((frame.id & filter.mask) == filter.id && (frame.extended != 0) == filter.extended)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool CanSubscriber::receive(CanFrameRef& ref, const uint32_t timeout)
+    {
+        CanPoolFrame* frame = nullptr;
+        if (mQueue == nullptr || xQueueReceive(mQueue, &frame, pdMS_TO_TICKS(timeout)) != pdTRUE)
+        {
+            return false;
+        }
+
+        ref.attach(frame, this);
+        return true;
+    }
+
+    uint8_t CanSubscriber::pending() const
+    {
+        return mQueue != nullptr ? uxQueueMessagesWaiting(mQueue) : 0;
+    }
+
+    uint8_t CanSubscriber::getQueueSize() const
+    {
+        return mQueueSize;
+    }
+
+    uint32_t CanSubscriber::getDropped() const
+    {
+        return mDropped;
+    }
+
+    uint32_t CanSubscriber::getDelivered() const
+    {
+        return mDelivered;
+    }
+
+    bool CanSubscriber::push(CanPoolFrame* frame)
+    {
+        if (mQueue == nullptr)
+        {
+            drop();
+            return false;
+        }
+
+        // Резерв исчерпан: подписчик теряет свои кадры, пул для остальных не расходуется
+        if (mOutstanding.load() >= mQueueSize &&
+            (mPolicy != CanOverflowPolicy::DROP_OLDEST || !dropOldest()))
+        {
+            drop();
+            return false;
+        }
+
+        CanFramePool::retain(frame);
+        mOutstanding.fetch_add(1);
+        if (xQueueSend(mQueue, &frame, 0) != pdTRUE)
+        {
+            CanFramePool::release(frame);
+            releaseRef();
+            drop();
+            return false;
+        }
+
+        mDelivered++;
+        return true;
+    }
+
+    void CanSubscriber::drop()
+    {
+        mDropped++;
+    }
+
+    void CanSubscriber::releaseRef()
+    {
+        mOutstanding.fetch_sub(1);
+    }
+
+    bool CanSubscriber::dropOldest()
+    {
+        CanPoolFrame* oldest = nullptr;
+        if (xQueueReceive(mQueue, &oldest, 0) != pdTRUE) return false;
+
+        CanFramePool::release(oldest);
+        releaseRef();
+        drop();
+        return true;
+    }
+} // namespace hardware
@@ -0,0 +1,53 @@
+#include "canbus/can_task_control.h"
+#include "freertos/task.h"
+
+namespace canbus
+{
+    bool CanTaskControl::start(esp32_c3_objects::Thread& thread, const TaskFunction_t function, void* params)
+    {
+        if (mActive) return true;
+
+        mStopRequested = false;
+        mParked = false;
+        mActive = thread.start(function, params);
+        return mActive;
+    }
+
+    void CanTaskControl::stop(esp32_c3_objects::Thread& thread)
+    {
+        if (!mActive) return;
+
+        mStopRequested = true;
+        while (!mParked)
+        {
+            vTaskDelay(pdMS_TO_TICKS(1));
+        }
+        thread.stop();
+        mActive = false;
+    }
+
+    bool CanTaskControl::running() const
+    {
+        return !mStopRequested;
+    }
+
+    bool CanTaskControl::delay(uint32_t ms) const
+    {
+        while (ms > 0 && running())
+        {
+            const uint32_t step = ms < CAN_TASK_STOP_POLL_MS ? ms : CAN_TASK_STOP_POLL_MS;
+            vTaskDelay(pdMS_TO_TICKS(step));
+            ms -= step;
+        }
+        return running();
+    }
+
+    void CanTaskControl::park()
+    {
+        mParked = true;
+        while (true)
+        {
+            vTaskDelay(portMAX_DELAY);
+        }
+    }
+} // namespace hardware
@@ -0,0 +1,209 @@
+#include "canbus/can_time_sync.h"
+#include <esp32-hal-log.h>
+#include <esp_timer.h>
+
+namespace canbus
+{
+    void canTimeSyncTask(void* params)
+    {
+        auto* timeSync = static_cast<CanTimeSync*>(params);
+        while (timeSync->mControl.running())
+        {
+            timeSync->handleMaster();
+            (void)timeSync->mControl.delay(timeSync->mConfig.period);
+        }
+        timeSync->mControl.park();
+    }
+
+    CanTimeSync::CanTimeSync(Can& can)
+        : mCan(can),
+          mThread("CAN_TIME_SYNC", 3072, 18)
+    {
+    }
+
+    CanTimeSync::~CanTimeSync()
+    {
+        end();
+    }
+
+    bool CanTimeSync::begin(const CanTimeSyncConfig& config)
+    {
+        if (mStarted) end();
+
+        mConfig = config;
+        if (mConfig.period == 0) mConfig.period = CAN_TIME_SYNC_PERIOD;
+
+        portENTER_CRITICAL(&mLock);
+        mServo.reset();
+        mSyncPending = false;
+        mStats = CanTimeSyncStats{};
+        portEXIT_CRITICAL(&mLock);
+
+        if (mConfig.role == CanTimeSyncRole::MASTER)
+        {
+            // Завершение передачи SYNC определяется по событию драйвера (Can других событий не использует)
+            if (twai_reconfigure_alerts(TWAI_ALERT_TX_SUCCESS | TWAI_ALERT_TX_FAILED, nullptr) != ESP_OK)
+            {
+                log_e("TX alerts unavailable");
+                return false;
+            }
+
+            if (!mControl.start(mThread, &canTimeSyncTask, this))
+            {
+                log_e("Failed to start time sync thread");
+                return false;
+            }
+        }
+
+        mCan.setTimeSync(this);
+        mStarted = true;
+        log_i("Time sync started as %s", mConfig.role == CanTimeSyncRole::MASTER ? "master" : "slave");
+        return true;
+    }
+
+    void CanTimeSync::end()
+    {
+        if (!mStarted) return;
+
+        mControl.stop(mThread);
+        mCan.setTimeSync(nullptr);
+        mStarted = false;
+        log_i("Time sync stopped");
+    }
+
+    int64_t CanTimeSync::getTime() const
+    {
+        return toSharedTime(esp_timer_get_time());
+    }
+
+    int64_t CanTimeSync::toSharedTime(const int64_t localTime) const
+    {
+        portENTER_CRITICAL(&mLock);
+        const int64_t result = mServo.toShared(localTime);
+        portEXIT_CRITICAL(&mLock);
+        return result;
+    }
+
+    bool CanTimeSync::isSynchronized() const
+    {
+        return mConfig.role == CanTimeSyncRole::MASTER || mStats.locked;
+    }
+
+    CanTimeSyncStats CanTimeSync::getStats() const
+    {
+        portENTER_CRITICAL(&mLock);
+        const CanTimeSyncStats stats = mStats;
+        portEXIT_CRITICAL(&mLock);
+        return stats;
+    }
+
+    bool CanTimeSync::processFrame(const CanFrame& frame, const int64_t rxTime)
+    {
+        if (mConfig.role != CanTimeSyncRole::SLAVE || (frame.extended != 0) != mConfig.extended) return false;
+
+        if (frame.id == mConfig.syncId && frame.length >= 1)
+        {
+            portENTER_CRITICAL(&mLock);
+            if (mSyncPending) mStats.missed++;
+            mSyncPending = true;
+            mSequence = frame.data.uint8[0];
+            mSyncRxTime = rxTime;
+            mStats.syncs++;
+            portEXIT_CRITICAL(&mLock);
+            return true;
+        }
+
+        if (frame.id == mConfig.followUpId && frame.length == CAN_FRAME_DATA_SIZE)
+        {
+            // Время ведущего узла: 56 бит в байтах 1-7 (little-endian)
+            int64_t masterTime = 0;
+            for (int i = CAN_FRAME_DATA_SIZE - 1; i >= 1; i--)
+            {
+                masterTime = (masterTime << 8) | frame.data.uint8[i];
+            }
+
+            portENTER_CRITICAL(&mLock);
+            if (mSyncPending && frame.data.uint8[0] == mSequence)
+            {
+                mServo.sample(masterTime, mSyncRxTime);
+                mSyncPending = false;
+                mStats.followUps++;
+                mStats.locked = mServo.isLocked();
+                mStats.lastErrorUs = static_cast<int32_t>(mServo.getLastError());
+                mStats.driftPpb = mServo.getDrift();
+            }
+            portEXIT_CRITICAL(&mLock);
+            return true;
+        }
+
+        return false;
+    }
+
+    void CanTimeSync::handleMaster()
+    {
+        // SYNC ставится в пустую очередь, поэтому первое завершение передачи относится к нему
+        CanFrame sync;
+        sync.id = mConfig.syncId;
+        sync.extended = mConfig.extended;
+        sync.length = 1;
+        sync.frequency = 0;
+        sync.data.uint8[0] = mSequence;
+        if (!mCan.sendWhenIdle(sync, CAN_TIME_SYNC_TX_TIMEOUT_MS))
+        {
+            // SYNC мог уйти на шину без достоверного момента передачи: ведомые дождутся следующего
+            log_w("Failed to send time SYNC");
+            mSequence++;
+            return;
+        }
+
+        int64_t txTime = 0;
+        if (!waitTxComplete(txTime))
+        {
+            // Без подтверждения момент передачи неизвестен, FOLLOW_UP не отправляется
+            log_w("SYNC completion not confirmed");
+            mSequence++;
+            return;
+        }
+
+        CanFrame followUp;
+        followUp.id = mConfig.followUpId;
+        followUp.extended = mConfig.extended;
+        followUp.length = CAN_FRAME_DATA_SIZE;
+        followUp.frequency = 0;
+        followUp.data.uint8[0] = mSequence;
+        for (int i = 1; i < CAN_FRAME_DATA_SIZE; i++)
+        {
+            followUp.data.uint8[i] = static_cast<uint8_t>(txTime >> (8 * (i - 1)));
+        }
+
+        portENTER_CRITICAL(&mLock);
+        mStats.syncs++;
+        portEXIT_CRITICAL(&mLock);
+
+        if (mCan.send(followUp))
+        {
+            portENTER_CRITICAL(&mLock);
+            mStats.followUps++;
+            portEXIT_CRITICAL(&mLock);
+        }
+        mSequence++;
+    }
+
+    bool CanTimeSync::waitTxComplete(int64_t& txTime)
+    {
+        const int64_t stopTime = esp_timer_get_time() + CAN_TIME_SYNC_TX_TIMEOUT_MS * 1000LL;
+        uint32_t alerts = 0;
+        while (esp_timer_get_time() < stopTime)
+        {
+            if (twai_read_alerts(&alerts, pdMS_TO_TICKS(CAN_TIME_SYNC_TX_TIMEOUT_MS)) != ESP_OK) continue;
+
+            if ((alerts & TWAI_ALERT_TX_SUCCESS) != 0)
+            {
+                txTime = esp_timer_get_time();
+                return true;
+            }
+            if ((alerts & TWAI_ALERT_TX_FAILED) != 0) return false;
+        }
+        return false;
+    }
+} // namespace hardware
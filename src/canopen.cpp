@@ -0,0 +1,415 @@
+#include "canbus/canopen.h"
+#include <esp32-hal-log.h>
+
+namespace canbus
+{
+    void canOpenTask(void* params)
+    {
+        auto* canOpen = static_cast<CanOpen*>(params);
+        while (canOpen->mControl.running())
+        {
+            canOpen->handle();
+        }
+        canOpen->mControl.park();
+    }
+
+    CanOpen::CanOpen(Can& can, CanOpenDictionary& dictionary, const uint8_t nodeId)
+        : mCan(can),
+          mDictionary(dictionary),
+          mNodeId(nodeId & 0x7F),
+          mThread("CANOPEN", 4096, 18),
+          mSemaphore(true),
+          mSubscriber(CAN_SUBSCRIBER_QUEUE_SIZE, CanOverflowPolicy::DROP_OLDEST)
+    {
+    }
+
+    CanOpen::~CanOpen()
+    {
+        end();
+    }
+
+    uint32_t CanOpen::getDefaultRpdoCobId(const uint8_t num) const
+    {
+        return 0x200 + 0x100 * (num % CANOPEN_NUM_RPDO) + mNodeId;
+    }
+
+    uint32_t CanOpen::getDefaultTpdoCobId(const uint8_t num) const
+    {
+        return 0x180 + 0x100 * (num % CANOPEN_NUM_TPDO) + mNodeId;
+    }
+
+    bool CanOpen::setRpdo(const uint8_t num,
+                          const uint32_t cobId,
+                          const uint8_t transmissionType,
+                          const uint32_t mappings[],
+                          const uint8_t count)
+    {
+        if (num >= CANOPEN_NUM_RPDO) return false;
+        if (!isValidTransmissionType(transmissionType))
+        {
+            log_w("RPDO %d: reserved transmission type %u", num, transmissionType);
+            return false;
+        }
+        if (!mSemaphore.take()) return false;
+
+        auto& rpdo = mRpdos[num];
+        rpdo.extended = (cobId & CANOPEN_COB_ID_EXTENDED) != 0;
+        rpdo.id = cobId & (rpdo.extended ? 0x1FFFFFFF : 0x7FF);
+        rpdo.transmissionType = transmissionType;
+        rpdo.syncPending = false;
+        rpdo.stats = CanOpenPdoStats{};
+        rpdo.valid = (cobId & CANOPEN_COB_ID_INVALID) == 0;
+        if (rpdo.valid && !rpdo.plan.compile(mDictionary, mappings, count))
+        {
+            log_w("Invalid RPDO %d mapping", num);
+            rpdo.valid = false;
+        }
+        rebuildDispatch();
+        log_d("RPDO %d set: id=0x%X, valid=%d", num, rpdo.id, rpdo.valid);
+
+        const bool valid = rpdo.valid;
+        (void)mSemaphore.give();
+
+        if (mStarted && !updateSubscription()) return false;
+        return valid;
+    }
+
+    bool CanOpen::setTpdo(const uint8_t num,
+                          const uint32_t cobId,
+                          const uint8_t transmissionType,
+                          const uint16_t eventTimer,
+                          const uint32_t mappings[],
+                          const uint8_t count)
+    {
+        if (num >= CANOPEN_NUM_TPDO) return false;
+        if (!isValidTransmissionType(transmissionType))
+        {
+            log_w("TPDO %d: reserved transmission type %u", num, transmissionType);
+            return false;
+        }
+        if (!mSemaphore.take()) return false;
+
+        auto& tpdo = mTpdos[num];
+        const bool extended = (cobId & CANOPEN_COB_ID_EXTENDED) != 0;
+        tpdo.transmissionType = transmissionType;
+        tpdo.syncCount = 0;
+        tpdo.eventPending = false;
+        tpdo.stats = CanOpenPdoStats{};
+        tpdo.valid = (cobId & CANOPEN_COB_ID_INVALID) == 0;
+        if (tpdo.valid && !tpdo.plan.compile(mDictionary, mappings, count))
+        {
+            log_w("Invalid TPDO %d mapping", num);
+            tpdo.valid = false;
+        }
+
+        tpdo.frame.clear();
+        tpdo.frame.id = cobId & (extended ? 0x1FFFFFFF : 0x7FF);
+        tpdo.frame.extended = extended;
+        tpdo.frame.length = tpdo.plan.getLength();
+        tpdo.frame.nextSendTime = 0;
+        // Циклическая передача использует период отправки кадра
+        tpdo.frame.frequency = transmissionType >= CANOPEN_TRANSMISSION_EVENT ? eventTimer : 0;
+        log_d("TPDO %d set: id=0x%X, type=%u, valid=%d", num, tpdo.frame.id, transmissionType, tpdo.valid);
+
+        (void)mSemaphore.give();
+        return tpdo.valid;
+    }
+
+    bool CanOpen::triggerTpdo(const uint8_t num)
+    {
+        if (num >= CANOPEN_NUM_TPDO || !mSemaphore.take()) return false;
+
+        bool result = false;
+        auto& tpdo = mTpdos[num];
+        if (tpdo.valid && mStarted)
+        {
+            if (tpdo.transmissionType >= CANOPEN_TRANSMISSION_EVENT)
+            {
+                // Событие перезапускает таймер циклической передачи
+                tpdo.frame.nextSendTime = 0;
+                result = sendTpdo(num);
+            }
+            else if (tpdo.transmissionType == 0)
+            {
+                tpdo.eventPending = true;
+                result = true;
+            }
+        }
+
+        (void)mSemaphore.give();
+        return result;
+    }
+
+    bool CanOpen::begin()
+    {
+        if (mStarted) return true;
+
+        mStarted = true;
+        if (!updateSubscription())
+        {
+            mStarted = false;
+            return false;
+        }
+        if (!mControl.start(mThread, &canOpenTask, this))
+        {
+            log_e("Failed to start CANopen thread");
+            mCan.unsubscribe(&mSubscriber);
+            mStarted = false;
+            return false;
+        }
+
+        log_i("CANopen node %u started", mNodeId);
+        return true;
+    }
+
+    void CanOpen::end()
+    {
+        if (!mStarted) return;
+
+        mControl.stop(mThread);
+        mCan.unsubscribe(&mSubscriber);
+        mStarted = false;
+        log_i("CANopen node %u stopped", mNodeId);
+    }
+
+    CanOpenPdoStats CanOpen::getRpdoStats(const uint8_t num) const
+    {
+        return num < CANOPEN_NUM_RPDO ? mRpdos[num].stats : CanOpenPdoStats{};
+    }
+
+    CanOpenPdoStats CanOpen::getTpdoStats(const uint8_t num) const
+    {
+        return num < CANOPEN_NUM_TPDO ? mTpdos[num].stats : CanOpenPdoStats{};
+    }
+
+    CanOpenSyncStats CanOpen::getSyncStats() const
+    {
+        return mSyncStats;
+    }
+
+    void CanOpen::handle()
+    {
+        CanFrameRef ref;
+        if (mSubscriber.receive(ref, nextTimeout()) && mSemaphore.take())
+        {
+            const CanFrame* frame = ref.get();
+            if (frame->rtr == 0)
+            {
+                if (frame->extended == 0 && frame->id == CANOPEN_SYNC_COB_ID)
+                {
+                    processSync(*frame);
+                }
+                else
+                {
+                    const int num = findRpdo(frame->id, frame->extended != 0);
+                    if (num >= 0) processRpdo(num, *frame);
+                }
+            }
+            (void)mSemaphore.give();
+        }
+        ref.reset();
+
+        if (!mSemaphore.take()) return;
+
+        const unsigned long currentTime = millis();
+        for (uint8_t i = 0; i < CANOPEN_NUM_TPDO; i++)
+        {
+            const auto& tpdo = mTpdos[i];
+            if (tpdo.valid && tpdo.frame.frequency != 0 && tpdo.frame.nextSendTime <= currentTime)
+            {
+                (void)sendTpdo(i);
+            }
+        }
+
+        (void)mSemaphore.give();
+    }
+
+    uint32_t CanOpen::dispatchKey(const uint32_t id, const bool extended)
+    {
+        return extended ? (id | CANOPEN_COB_ID_EXTENDED) : id;
+    }
+
+    void CanOpen::rebuildDispatch()
+    {
+        mNumDispatch = 0;
+        for (uint8_t i = 0; i < CANOPEN_NUM_RPDO; i++)
+        {
+            if (!mRpdos[i].valid) continue;
+
+            // Вставка с сохранением сортировки по ключу
+            const uint32_t key = dispatchKey(mRpdos[i].id, mRpdos[i].extended);
+            int pos = mNumDispatch;
+            while (pos > 0 && mDispatch[pos - 1].key > key)
+            {
+                mDispatch[pos] = mDispatch[pos - 1];
+                pos--;
+            }
+            mDispatch[pos].key = key;
+            mDispatch[pos].rpdo = i;
+            mNumDispatch++;
+        }
+    }
+
+    int CanOpen::findRpdo(const uint32_t id, const bool extended) const
+    {
+        const uint32_t key = dispatchKey(id, extended);
+        int low = 0;
+        int high = mNumDispatch - 1;
+        while (low <= high)
+        {
+            const int middle = (low + high) / 2;
+            if (mDispatch[middle].key == key) return mDispatch[middle].rpdo;
+            if (mDispatch[middle].key < key) low = middle + 1;
+            else high = middle - 1;
+        }
+        return -1;
+    }
+
+    bool CanOpen::isValidTransmissionType(const uint8_t transmissionType)
+    {
+        return transmissionType <= CANOPEN_TRANSMISSION_SYNC_MAX || transmissionType >= CANOPEN_TRANSMISSION_EVENT;
+    }
+
+    bool CanOpen::updateSubscription()
+    {
+        mCan.unsubscribe(&mSubscriber);
+
+        if (!mSemaphore.take()) return false;
+
+        mSubscriber.clearFilters();
+        (void)mSubscriber.addFilter(CANOPEN_SYNC_COB_ID, 0x7FF, false);
+        for (uint8_t i = 0; i < mNumDispatch; i++)
+        {
+            const auto& rpdo = mRpdos[mDispatch[i].rpdo];
+            (void)mSubscriber.addFilter(rpdo.id, rpdo.extended ? 0x1FFFFFFF : 0x7FF, rpdo.extended);
+        }
+
+        (void)mSemaphore.give();
+
+        // Без подписки узел не получает SYNC и RPDO
+        if (!mCan.subscribe(&mSubscriber))
+        {
+            log_e("CANopen node %u: subscription rejected", mNodeId);
+            return false;
+        }
+        return true;
+    }
+
+    void CanOpen::processSync(const CanFrame& sync)
+    {
+        mSyncStats.syncs++;
+
+        for (auto& rpdo : mRpdos)
+        {
+            if (rpdo.valid && rpdo.syncPending)
+            {
+                unpackRpdo(rpdo, rpdo.data, rpdo.length);
+                rpdo.syncPending = false;
+            }
+        }
+
+        bool sent = false;
+        for (uint8_t i = 0; i < CANOPEN_NUM_TPDO; i++)
+        {
+            auto& tpdo = mTpdos[i];
+            if (!tpdo.valid || tpdo.transmissionType > CANOPEN_TRANSMISSION_SYNC_MAX) continue;
+
+            bool due = false;
+            if (tpdo.transmissionType == 0)
+            {
+                due = tpdo.eventPending;
+                tpdo.eventPending = false;
+            }
+            else if (++tpdo.syncCount >= tpdo.transmissionType)
+            {
+                tpdo.syncCount = 0;
+                due = true;
+            }
+
+            if (due) sent = sendTpdo(i) || sent;
+        }
+
+        if (sent)
+        {
+            const auto latency = static_cast<uint32_t>(mCan.getTime() - sync.timestamp);
+            mSyncStats.lastLatencyUs = latency;
+            if (latency > mSyncStats.maxLatencyUs) mSyncStats.maxLatencyUs = latency;
+        }
+    }
+
+    void CanOpen::processRpdo(const uint8_t num, const CanFrame& frame)
+    {
+        auto& rpdo = mRpdos[num];
+        if (rpdo.transmissionType <= CANOPEN_TRANSMISSION_SYNC_MAX)
+        {
+            // Синхронный RPDO применяется при следующем SYNC
+            memcpy(rpdo.data, frame.data.bytes, CAN_FRAME_DATA_SIZE);
+            rpdo.length = frame.length;
+            rpdo.syncPending = true;
+            return;
+        }
+
+        unpackRpdo(rpdo, frame.data.bytes, frame.length);
+    }
+
+    void CanOpen::unpackRpdo(Rpdo& rpdo, const uint8_t* data, const uint8_t length)
+    {
+        const uint32_t start = ESP.getCycleCount();
+        if (!rpdo.plan.unpack(data, length))
+        {
+            log_w("RPDO 0x%X too short: %u", rpdo.id, length);
+            return;
+        }
+        const uint32_t cycles = ESP.getCycleCount() - start;
+
+        rpdo.stats.count++;
+        rpdo.stats.lastCycles = cycles;
+        if (cycles > rpdo.stats.maxCycles) rpdo.stats.maxCycles = cycles;
+    }
+
+    bool CanOpen::sendTpdo(const uint8_t num)
+    {
+        auto& tpdo = mTpdos[num];
+
+        const uint32_t start = ESP.getCycleCount();
+        tpdo.plan.pack(tpdo.frame.data.bytes);
+        const uint32_t cycles = ESP.getCycleCount() - start;
+
+        tpdo.stats.lastCycles = cycles;
+        if (cycles > tpdo.stats.maxCycles) tpdo.stats.maxCycles = cycles;
+
+        // Синхронные TPDO отправляются без ограничения периодом
+        if (tpdo.frame.frequency == 0) tpdo.frame.nextSendTime = 0;
+        if (!mCan.send(tpdo.frame))
+        {
+            if (tpdo.frame.frequency != 0)
+            {
+                // Шина не готова или кадр отброшен: повтор не чаще CANOPEN_SEND_RETRY_MS
+                const unsigned long retryTime = millis() + (tpdo.frame.frequency > CANOPEN_SEND_RETRY_MS
+                                                                ? tpdo.frame.frequency
+                                                                : CANOPEN_SEND_RETRY_MS);
+                if (tpdo.frame.nextSendTime < retryTime) tpdo.frame.nextSendTime = retryTime;
+            }
+            return false;
+        }
+
+        tpdo.stats.count++;
+        return true;
+    }
+
+    uint32_t CanOpen::nextTimeout() const
+    {
+        uint32_t timeout = CANOPEN_MAX_WAIT_MS;
+        const unsigned long currentTime = millis();
+        for (const auto& tpdo : mTpdos)
+        {
+            if (!tpdo.valid || tpdo.frame.frequency == 0) continue;
+
+            // Неотправленные TPDO откладываются в sendTpdo(), здесь только срок очередной отправки
+            if (tpdo.frame.nextSendTime <= currentTime) return 1;
+            const unsigned long wait = tpdo.frame.nextSendTime - currentTime;
+            if (wait < timeout) timeout = wait;
+        }
+        return timeout;
+    }
+} // namespace hardware
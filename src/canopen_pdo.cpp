@@ -0,0 +1,137 @@
+#include "canbus/canopen_pdo.h"
+#include <cstring>
+
+namespace canbus
+{
+    int CanOpenDictionary::add(const uint16_t index, const uint8_t subIndex, void* data, const uint8_t bitLength)
+    {
+        if (data == nullptr || bitLength == 0 || bitLength > CANOPEN_PDO_MAX_BITS) return -1;
+        if (find(index, subIndex) != nullptr || mNumObjects >= CANOPEN_NUM_OBJECT) return -1;
+
+        auto& object = mObjects[mNumObjects];
+        object.index = index;
+        object.subIndex = subIndex;
+        object.bitLength = bitLength;
+        object.data = data;
+        return mNumObjects++;
+    }
+
+    const CanOpenObject* CanOpenDictionary::find(const uint16_t index, const uint8_t subIndex) const
+    {
+        for (uint8_t i = 0; i < mNumObjects; i++)
+        {
+            if (mObjects[i].index == index && mObjects[i].subIndex == subIndex) return &mObjects[i];
+        }
+        return nullptr;
+    }
+
+    bool CanOpenPdoPlan::compile(const CanOpenDictionary& dictionary, const uint32_t mappings[], const uint8_t count)
+    {
+        mNumCopies = 0;
+        mNumShifts = 0;
+        mLength = 0;
+        if (count > CANOPEN_PDO_MAX_MAPPING || (count > 0 && mappings == nullptr)) return false;
+
+        uint8_t bitOffset = 0;
+        for (uint8_t i = 0; i < count; i++)
+        {
+            const auto index = static_cast<uint16_t>(mappings[i] >> 16);
+            const auto subIndex = static_cast<uint8_t>(mappings[i] >> 8);
+            const auto bitLength = static_cast<uint8_t>(mappings[i]);
+            const CanOpenObject* object = dictionary.find(index, subIndex);
+
+            if (object == nullptr || bitLength == 0 || bitLength > object->bitLength ||
+                bitOffset + bitLength > CANOPEN_PDO_MAX_BITS)
+            {
+                mNumCopies = 0;
+                mNumShifts = 0;
+                return false;
+            }
+
+            auto* data = static_cast<uint8_t*>(object->data);
+            const uint8_t objectSize = (object->bitLength + 7) / 8;
+            if (bitOffset % 8 == 0 && bitLength % 8 == 0)
+            {
+                // Смежные в памяти переменные, идущие подряд в кадре, копируются одной операцией
+                Operation* last = mNumCopies > 0 ? &mCopies[mNumCopies - 1] : nullptr;
+                if (last != nullptr && last->data + last->size == data &&
+                    last->offset + last->size == bitOffset / 8 && last->size == last->objectSize &&
+                    bitLength / 8 == objectSize)
+                {
+                    last->size += objectSize;
+                    last->objectSize += objectSize;
+                }
+                else
+                {
+                    auto& copy = mCopies[mNumCopies++];
+                    copy.data = data;
+                    copy.offset = bitOffset / 8;
+                    copy.size = bitLength / 8;
+                    copy.objectSize = objectSize;
+                }
+            }
+            else
+            {
+                auto& shift = mShifts[mNumShifts++];
+                shift.data = data;
+                shift.offset = bitOffset;
+                shift.size = bitLength;
+                shift.objectSize = objectSize;
+            }
+            bitOffset += bitLength;
+        }
+
+        mLength = (bitOffset + 7) / 8;
+        return true;
+    }
+
+    void CanOpenPdoPlan::pack(uint8_t* data) const
+    {
+        uint64_t word = 0;
+        for (uint8_t i = 0; i < mNumShifts; i++)
+        {
+            const auto& shift = mShifts[i];
+            uint64_t value = 0;
+            memcpy(&value, shift.data, shift.objectSize);
+            const uint64_t mask = shift.size < 64 ? (1ULL << shift.size) - 1 : ~0ULL;
+            word |= (value & mask) << shift.offset;
+        }
+        memcpy(data, &word, CANOPEN_PDO_MAX_LENGTH);
+
+        for (uint8_t i = 0; i < mNumCopies; i++)
+        {
+            const auto& copy = mCopies[i];
+            memcpy(data + copy.offset, copy.data, copy.size);
+        }
+    }
+
+    bool CanOpenPdoPlan::unpack(const uint8_t* data, const uint8_t length) const
+    {
+        if (length < mLength) return false;
+
+        for (uint8_t i = 0; i < mNumCopies; i++)
+        {
+            const auto& copy = mCopies[i];
+            memcpy(copy.data, data + copy.offset, copy.size);
+            if (copy.size < copy.objectSize) memset(copy.data + copy.size, 0, copy.objectSize - copy.size);
+        }
+
+        if (mNumShifts == 0) return true;
+
+        uint64_t word = 0;
+        memcpy(&word, data, length < CANOPEN_PDO_MAX_LENGTH ? length : CANOPEN_PDO_MAX_LENGTH);
+        for (uint8_t i = 0; i < mNumShifts; i++)
+        {
+            const auto& shift = mShifts[i];
+            const uint64_t mask = shift.size < 64 ? (1ULL << shift.size) - 1 : ~0ULL;
+            const uint64_t value = (word >> shift.offset) & mask;
+            memcpy(shift.data, &value, shift.objectSize);
+        }
+        return true;
+    }
+
+    uint8_t CanOpenPdoPlan::getLength() const
+    {
+        return mLength;
+    }
+} // namespace hardware
@@ -0,0 +1,238 @@
+#include <unity.h>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include "canbus/canopen_pdo.h"
+
+using namespace canbus;
+
+namespace
+{
+    constexpr int BENCH_FRAMES = 1000000;
+    constexpr int NUM_PDO = 4;
+
+    /**
+     * @brief Переменные приложения одного PDO: выровненные и невыровненные объекты
+     */
+    struct Values
+    {
+        uint16_t speed = 0;
+        uint16_t torque = 0;
+        uint32_t position = 0;
+        uint8_t flags = 0;
+        uint16_t current = 0;
+        uint8_t mode = 0;
+    };
+
+    /**
+     * @brief Отображение PDO: 16 + 16 + 3 + 13 + 8 бит (копирование и сдвиги)
+     */
+    struct Node
+    {
+        CanOpenDictionary dictionary;
+        Values values[NUM_PDO];
+        CanOpenPdoPlan plans[NUM_PDO];
+
+        Node()
+        {
+            for (int i = 0; i < NUM_PDO; i++)
+            {
+                const auto index = static_cast<uint16_t>(0x6000 + i);
+                (void)dictionary.add(index, 1, values[i].speed);
+                (void)dictionary.add(index, 2, values[i].torque);
+                (void)dictionary.add(index, 3, values[i].position);
+                (void)dictionary.add(index, 4, values[i].flags);
+                (void)dictionary.add(index, 5, values[i].current);
+                (void)dictionary.add(index, 6, values[i].mode);
+
+                const uint32_t mappings[] = {
+                    CanOpenPdoPlan::mapping(index, 1, 16),
+                    CanOpenPdoPlan::mapping(index, 2, 16),
+                    CanOpenPdoPlan::mapping(index, 4, 3),
+                    CanOpenPdoPlan::mapping(index, 5, 13),
+                    CanOpenPdoPlan::mapping(index, 6, 8)
+                };
+                TEST_ASSERT_TRUE(plans[i].compile(dictionary, mappings, 5));
+            }
+        }
+    };
+
+    /**
+     * @brief Упаковка, написанная вручную под одно отображение (эталон и нижняя граница стоимости)
+     */
+    void referencePack(const Values& values, uint8_t* data)
+    {
+        uint64_t word = 0;
+        uint8_t offset = 0;
+        auto put = [&](const uint64_t value, const uint8_t bits)
+        {
+            word |= (value & ((1ULL << bits) - 1)) << offset;
+            offset += bits;
+        };
+        put(values.speed, 16);
+        put(values.torque, 16);
+        put(values.flags, 3);
+        put(values.current, 13);
+        put(values.mode, 8);
+        memcpy(data, &word, CANOPEN_PDO_MAX_LENGTH);
+    }
+
+    void fillValues(Values& values, const uint32_t seed)
+    {
+        const uint32_t value = seed * 2654435761u + 1;
+        values.speed = static_cast<uint16_t>(value);
+        values.torque = static_cast<uint16_t>(value >> 7);
+        values.flags = static_cast<uint8_t>(value >> 3) & 0x07;
+        values.current = static_cast<uint16_t>(value >> 11) & 0x1FFF;
+        values.mode = static_cast<uint8_t>(value >> 24);
+    }
+
+    template <typename Function>
+    double nsPerFrame(Function function)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        function();
+        const auto stop = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::nano>(stop - start).count() / BENCH_FRAMES;
+    }
+} // namespace
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+void test_pack_matches_reference()
+{
+    Node node;
+    TEST_ASSERT_EQUAL_UINT8(7, node.plans[0].getLength());
+
+    uint8_t data[CANOPEN_PDO_MAX_LENGTH];
+    uint8_t expected[CANOPEN_PDO_MAX_LENGTH];
+    for (uint32_t seed = 0; seed < 10000; seed++)
+    {
+        fillValues(node.values[0], seed);
+        node.plans[0].pack(data);
+        referencePack(node.values[0], expected);
+        TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, data, node.plans[0].getLength());
+    }
+}
+
+void test_unpack_round_trip()
+{
+    Node node;
+    uint8_t data[CANOPEN_PDO_MAX_LENGTH];
+    for (uint32_t seed = 0; seed < 10000; seed++)
+    {
+        Values source;
+        fillValues(source, seed);
+        referencePack(source, data);
+
+        TEST_ASSERT_TRUE(node.plans[1].unpack(data, node.plans[1].getLength()));
+        TEST_ASSERT_EQUAL_UINT16(source.speed, node.values[1].speed);
+        TEST_ASSERT_EQUAL_UINT16(source.torque, node.values[1].torque);
+        TEST_ASSERT_EQUAL_UINT8(source.flags, node.values[1].flags);
+        TEST_ASSERT_EQUAL_UINT16(source.current, node.values[1].current);
+        TEST_ASSERT_EQUAL_UINT8(source.mode, node.values[1].mode);
+    }
+
+    TEST_ASSERT_FALSE(node.plans[1].unpack(data, node.plans[1].getLength() - 1));
+}
+
+void test_invalid_mapping()
+{
+    Node node;
+    CanOpenPdoPlan plan;
+    const uint32_t unknown[] = {CanOpenPdoPlan::mapping(0x7000, 0, 8)};
+    const uint32_t tooLong[] = {CanOpenPdoPlan::mapping(0x6000, 4, 16)};
+    TEST_ASSERT_FALSE(plan.compile(node.dictionary, unknown, 1));
+    TEST_ASSERT_FALSE(plan.compile(node.dictionary, tooLong, 1));
+    TEST_ASSERT_EQUAL(-1, node.dictionary.add(0x6000, 1, node.values[0].speed));
+}
+
+void test_pack_unpack_cost()
+{
+    Node node;
+    uint8_t data[CANOPEN_PDO_MAX_LENGTH];
+    volatile uint8_t sink = 0;
+
+    const double pack = nsPerFrame([&]
+    {
+        for (int i = 0; i < BENCH_FRAMES; i++)
+        {
+            node.values[0].speed = static_cast<uint16_t>(i);
+            node.plans[0].pack(data);
+            sink = sink ^ data[0];
+        }
+    });
+    const double reference = nsPerFrame([&]
+    {
+        for (int i = 0; i < BENCH_FRAMES; i++)
+        {
+            node.values[0].speed = static_cast<uint16_t>(i);
+            referencePack(node.values[0], data);
+            sink = sink ^ data[0];
+        }
+    });
+    const double unpack = nsPerFrame([&]
+    {
+        for (int i = 0; i < BENCH_FRAMES; i++)
+        {
+            data[0] = static_cast<uint8_t>(i);
+            (void)node.plans[0].unpack(data, CANOPEN_PDO_MAX_LENGTH);
+            sink = sink ^ static_cast<uint8_t>(node.values[0].speed);
+        }
+    });
+
+    char message[128];
+    snprintf(message, sizeof(message),
+             "PDO per frame: plan pack %.1f ns, hand-coded pack %.1f ns, plan unpack %.1f ns",
+             pack, reference, unpack);
+    TEST_MESSAGE(message);
+}
+
+void test_sync_to_tpdo_cost()
+{
+    // Работа задачи CanOpen на SYNC: применение синхронных RPDO и упаковка всех TPDO
+    Node rpdos;
+    Node tpdos;
+    uint8_t received[NUM_PDO][CANOPEN_PDO_MAX_LENGTH] = {};
+    uint8_t frames[NUM_PDO][CANOPEN_PDO_MAX_LENGTH];
+    volatile uint8_t sink = 0;
+
+    const double sync = nsPerFrame([&]
+    {
+        for (int i = 0; i < BENCH_FRAMES; i++)
+        {
+            received[i % NUM_PDO][0] = static_cast<uint8_t>(i);
+            for (int pdo = 0; pdo < NUM_PDO; pdo++)
+            {
+                (void)rpdos.plans[pdo].unpack(received[pdo], CANOPEN_PDO_MAX_LENGTH);
+            }
+            for (int pdo = 0; pdo < NUM_PDO; pdo++)
+            {
+                tpdos.plans[pdo].pack(frames[pdo]);
+            }
+            sink = sink ^ frames[i % NUM_PDO][0];
+        }
+    });
+
+    char message[128];
+    snprintf(message, sizeof(message), "SYNC to TPDO (%d RPDO unpack + %d TPDO pack, without driver): %.1f ns",
+             NUM_PDO, NUM_PDO, sync);
+    TEST_MESSAGE(message);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_pack_matches_reference);
+    RUN_TEST(test_unpack_round_trip);
+    RUN_TEST(test_invalid_mapping);
+    RUN_TEST(test_pack_unpack_cost);
+    RUN_TEST(test_sync_to_tpdo_cost);
+    return UNITY_END();
+}
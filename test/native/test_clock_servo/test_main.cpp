@@ -0,0 +1,195 @@
+#include <unity.h>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include "canbus/can_clock_servo.h"
+
+using namespace canbus;
+
+namespace
+{
+    constexpr int NUM_SLAVES = 3;           ///< Количество ведомых узлов на шине
+    constexpr int SETTLE_SAMPLES = 10;      ///< Отсчетов до проверки точности
+    constexpr int64_t MAX_ERROR_US = 50;    ///< Допустимое расхождение с ведущим узлом (мкс)
+
+    /**
+     * @brief Локальные часы узла с дрейфом и смещением
+     */
+    struct SimClock
+    {
+        double skewPpm = 0;
+        double offsetUs = 0;
+
+        [[nodiscard]] int64_t read(const double trueTime) const
+        {
+            return std::llround(trueTime * (1.0 + skewPpm * 1e-6) + offsetUs);
+        }
+
+        [[nodiscard]] double trueTimeAt(const double localTime) const
+        {
+            return (localTime - offsetUs) / (1.0 + skewPpm * 1e-6);
+        }
+    };
+
+    /**
+     * @brief Результат моделирования
+     */
+    struct SimResult
+    {
+        bool locked[NUM_SLAVES] = {};
+        int lockSample[NUM_SLAVES] = {};
+        int64_t maxError = 0;
+        int64_t maxSpread = 0;
+        int64_t maxBackward = 0;
+        int32_t drift[NUM_SLAVES] = {};
+    };
+
+    /**
+     * @brief Моделирование шины: ведущий узел и ведомые с разным дрейфом часов
+     * @param master Часы ведущего узла
+     * @param slaves Часы ведомых узлов
+     * @param periodMs Период SYNC (мс)
+     * @param syncs Количество SYNC
+     * @param masterStepAt Номер SYNC, с которого время ведущего узла сдвигается (-1 - без сдвига)
+     * @param masterStepUs Сдвиг времени ведущего узла (мкс)
+     */
+    SimResult simulate(SimClock master, const SimClock (&slaves)[NUM_SLAVES], const uint32_t periodMs,
+                       const int syncs, const int masterStepAt = -1, const double masterStepUs = 0)
+    {
+        std::mt19937 random(12345);
+        std::uniform_real_distribution<double> arbitration(0, 300); // ожидание освобождения шины
+        std::uniform_real_distribution<double> txLatency(0, 3);     // событие TX_SUCCESS
+        std::uniform_real_distribution<double> rxLatency(5, 15);    // прерывание и задача приема
+        std::uniform_real_distribution<double> probe(0.05, 0.95);
+
+        CanClockServo servos[NUM_SLAVES];
+        SimResult result;
+        int settleFrom[NUM_SLAVES] = {};
+        int64_t lastShared[NUM_SLAVES] = {};
+
+        // Все чтения общей шкалы узла после захвата идут по возрастанию локального времени
+        // и не должны убывать (кроме скачка после сдвига времени ведущего узла)
+        auto observe = [&](const int i, const int k, const int64_t shared)
+        {
+            const bool checked = result.locked[i] && k > result.lockSample[i] &&
+                (masterStepAt < 0 || k < masterStepAt || k > masterStepAt + SETTLE_SAMPLES);
+            if (checked && lastShared[i] - shared > result.maxBackward) result.maxBackward = lastShared[i] - shared;
+            lastShared[i] = shared;
+        };
+
+        for (int k = 1; k <= syncs; k++)
+        {
+            if (k == masterStepAt)
+            {
+                master.offsetUs += masterStepUs;
+                for (int& from : settleFrom) from = k + SETTLE_SAMPLES;
+            }
+
+            // SYNC завершается на шине, ведущий фиксирует время по событию драйвера
+            const double syncTime = master.trueTimeAt(k * periodMs * 1000.0) + arbitration(random);
+            const int64_t masterTx = master.read(syncTime + txLatency(random));
+
+            for (int i = 0; i < NUM_SLAVES; i++)
+            {
+                const int64_t rx = slaves[i].read(syncTime + rxLatency(random));
+                auto& servo = servos[i];
+
+                observe(i, k, servo.toShared(rx));
+                servo.sample(masterTx, rx);
+                if (servo.isLocked() && !result.locked[i])
+                {
+                    result.lockSample[i] = k;
+                    result.locked[i] = true;
+                }
+                observe(i, k, servo.toShared(rx));
+                result.drift[i] = servo.getDrift();
+            }
+
+            // Общее время узлов сравнивается с ведущим в случайный момент до следующего SYNC
+            if (k < SETTLE_SAMPLES) continue;
+
+            const double probeTime = syncTime + probe(random) * periodMs * 1000.0;
+            int64_t low = INT64_MAX;
+            int64_t high = INT64_MIN;
+            for (int i = 0; i < NUM_SLAVES; i++)
+            {
+                if (k < settleFrom[i]) continue;
+
+                const int64_t shared = servos[i].toShared(slaves[i].read(probeTime));
+                observe(i, k, shared);
+                const int64_t error = std::llabs(shared - master.read(probeTime));
+                if (error > result.maxError) result.maxError = error;
+                if (shared < low) low = shared;
+                if (shared > high) high = shared;
+            }
+            if (high >= low && high - low > result.maxSpread) result.maxSpread = high - low;
+        }
+        return result;
+    }
+
+    void checkResult(const char* name, const SimResult& result, const SimClock& master,
+                     const SimClock (&slaves)[NUM_SLAVES])
+    {
+        char message[160];
+        snprintf(message, sizeof(message), "%s: max error %lld us, node spread %lld us, backward %lld us",
+                 name, static_cast<long long>(result.maxError), static_cast<long long>(result.maxSpread),
+                 static_cast<long long>(result.maxBackward));
+        TEST_MESSAGE(message);
+
+        for (int i = 0; i < NUM_SLAVES; i++)
+        {
+            TEST_ASSERT_TRUE_MESSAGE(result.locked[i], name);
+            TEST_ASSERT_TRUE_MESSAGE(result.lockSample[i] <= SETTLE_SAMPLES, name);
+
+            // Коррекция частоты близка к отношению частот ведущего и ведомого
+            const double expected = ((1.0 + master.skewPpm * 1e-6) / (1.0 + slaves[i].skewPpm * 1e-6) - 1.0) * 1e9;
+            TEST_ASSERT_INT64_WITHIN(2000, std::llround(expected), result.drift[i]);
+        }
+        TEST_ASSERT_TRUE_MESSAGE(result.maxError <= MAX_ERROR_US, name);
+        TEST_ASSERT_TRUE_MESSAGE(result.maxSpread <= MAX_ERROR_US, name);
+        TEST_ASSERT_TRUE_MESSAGE(result.maxBackward == 0, name);
+    }
+} // namespace
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+void test_skew_short_period()
+{
+    const SimClock master{30, 5e6};
+    const SimClock slaves[NUM_SLAVES] = {{-40, 1.2e6}, {100, 7.7e6}, {-250, 0}};
+    checkResult("1 s period", simulate(master, slaves, 1000, 300), master, slaves);
+}
+
+void test_skew_long_period()
+{
+    const SimClock master{0, 0};
+    const SimClock slaves40[NUM_SLAVES] = {{40, 3e6}, {-40, 9e6}, {25, 1e5}};
+    checkResult("30 s period, 40 ppm", simulate(master, slaves40, 30000, 60), master, slaves40);
+
+    const SimClock slaves250[NUM_SLAVES] = {{250, 3e6}, {-250, 9e6}, {180, 1e5}};
+    checkResult("5 s period, 250 ppm", simulate(master, slaves250, 5000, 120), master, slaves250);
+    checkResult("30 s period, 250 ppm", simulate(master, slaves250, 30000, 60), master, slaves250);
+}
+
+void test_master_time_step()
+{
+    const SimClock master{10, 0};
+    const SimClock slaves[NUM_SLAVES] = {{-60, 3e6}, {120, 9e6}, {200, 1e5}};
+    checkResult("master step +2 s", simulate(master, slaves, 1000, 200, 100, 2e6), master, slaves);
+    checkResult("master step -2 s", simulate(master, slaves, 1000, 200, 100, -2e6), master, slaves);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_skew_short_period);
+    RUN_TEST(test_skew_long_period);
+    RUN_TEST(test_master_time_step);
+    return UNITY_END();
+}
@@ -0,0 +1,205 @@
+#include <unity.h>
+#include <chrono>
+#include <cstdio>
+#include <initializer_list>
+#include "canbus/can_e2e.h"
+
+using namespace canbus;
+
+namespace
+{
+    constexpr int BENCH_FRAMES = 1000000;
+
+    /**
+     * @brief Побитовый расчет CRC8 (эталон и прежняя реализация в приложениях)
+     */
+    uint8_t bitwiseCrc(const CanE2EProfile& profile, const uint8_t* data, const uint8_t length)
+    {
+        const uint8_t polynomial = profile.crc == CanE2ECrc::CRC8H2F ? 0x2F : 0x1D;
+        uint8_t crc = 0xFF;
+        auto feed = [&](const uint8_t byte)
+        {
+            crc ^= byte;
+            for (int bit = 0; bit < 8; bit++)
+            {
+                crc = (crc & 0x80) ? static_cast<uint8_t>((crc << 1) ^ polynomial) : static_cast<uint8_t>(crc << 1);
+            }
+        };
+
+        feed(static_cast<uint8_t>(profile.dataId));
+        feed(static_cast<uint8_t>(profile.dataId >> 8));
+        for (uint8_t i = 0; i < length; i++)
+        {
+            if (i != profile.crcByte) feed(data[i]);
+        }
+        return crc ^ 0xFF;
+    }
+
+    CanE2EProfile makeProfile(const CanE2ECrc crc)
+    {
+        CanE2EProfile profile;
+        profile.configured = true;
+        profile.crc = crc;
+        profile.dataId = 0x1234;
+        return profile;
+    }
+
+    void fillFrame(uint8_t* data, const uint32_t seed)
+    {
+        uint32_t value = seed * 2654435761u + 1;
+        for (int i = 0; i < 8; i++)
+        {
+            value = value * 1103515245u + 12345;
+            data[i] = static_cast<uint8_t>(value >> 16);
+        }
+    }
+
+    template <typename Function>
+    double nsPerFrame(Function function)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        function();
+        const auto stop = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::nano>(stop - start).count() / BENCH_FRAMES;
+    }
+} // namespace
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+void test_table_matches_bitwise()
+{
+    for (const auto crc : {CanE2ECrc::SAE_J1850, CanE2ECrc::CRC8H2F})
+    {
+        const CanE2EProfile profile = makeProfile(crc);
+        uint8_t data[8];
+        for (uint32_t seed = 0; seed < 10000; seed++)
+        {
+            fillFrame(data, seed);
+            TEST_ASSERT_EQUAL_HEX8(bitwiseCrc(profile, data, 8), CanE2E::calculateCrc(profile, data, 8));
+        }
+    }
+}
+
+void test_crc_check_values()
+{
+    // Стандартные контрольные значения CRC-8 по строке "123456789": идентификатор данных
+    // подается младшим байтом вперед, поэтому первые два символа задаются через dataId
+    const uint8_t digits[] = {'3', '4', '5', '6', '7', '8', '9'};
+    CanE2EProfile profile = makeProfile(CanE2ECrc::SAE_J1850);
+    profile.dataId = '1' | '2' << 8;
+    profile.crcByte = sizeof(digits);
+    TEST_ASSERT_EQUAL_HEX8(0x4B, CanE2E::calculateCrc(profile, digits, sizeof(digits)));
+
+    profile.crc = CanE2ECrc::CRC8H2F;
+    TEST_ASSERT_EQUAL_HEX8(0xDF, CanE2E::calculateCrc(profile, digits, sizeof(digits)));
+}
+
+void test_protected_frame_vectors()
+{
+    // Эталон рассчитан независимо: CRC по dataId (LSB, MSB) и байтам 1-7, счетчик 5 в младшей тетраде байта 1
+    const uint8_t expectedJ1850[8] = {0x5B, 0xA5, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66};
+    const uint8_t expectedH2F[8] = {0x87, 0xA5, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66};
+
+    for (const auto crc : {CanE2ECrc::SAE_J1850, CanE2ECrc::CRC8H2F})
+    {
+        CanE2EProfile profile = makeProfile(crc);
+        profile.dataId = 0x0123;
+        uint8_t data[8] = {0x00, 0xA0, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66};
+        TEST_ASSERT_TRUE(CanE2E::protect(profile, data, 8, 5));
+        TEST_ASSERT_EQUAL_HEX8_ARRAY(crc == CanE2ECrc::CRC8H2F ? expectedH2F : expectedJ1850, data, 8);
+
+        CanE2EState state;
+        TEST_ASSERT_EQUAL(CanE2EStatus::OK, CanE2E::check(profile, data, 8, state));
+    }
+}
+
+void test_profile_validation()
+{
+    CanE2EProfile profile = makeProfile(CanE2ECrc::SAE_J1850);
+    TEST_ASSERT_TRUE(CanE2E::isValid(profile));
+
+    profile.counterShift = 4;
+    TEST_ASSERT_TRUE(CanE2E::isValid(profile));
+    profile.counterShift = 2;
+    TEST_ASSERT_FALSE(CanE2E::isValid(profile));
+
+    profile.counterShift = 0;
+    profile.counterByte = profile.crcByte;
+    TEST_ASSERT_FALSE(CanE2E::isValid(profile));
+
+    profile.counterByte = CAN_E2E_MAX_LENGTH;
+    TEST_ASSERT_FALSE(CanE2E::isValid(profile));
+}
+
+void test_protect_and_check_sequence()
+{
+    const CanE2EProfile profile = makeProfile(CanE2ECrc::SAE_J1850);
+    CanE2EState state;
+    uint8_t data[8] = {};
+
+    for (uint8_t counter = 0; counter < 40; counter++)
+    {
+        TEST_ASSERT_TRUE(CanE2E::protect(profile, data, 8, counter & CAN_E2E_COUNTER_MASK));
+        TEST_ASSERT_EQUAL(CanE2EStatus::OK, CanE2E::check(profile, data, 8, state));
+    }
+
+    TEST_ASSERT_EQUAL(CanE2EStatus::REPEATED, CanE2E::check(profile, data, 8, state));
+    data[4] ^= 0x01;
+    TEST_ASSERT_EQUAL(CanE2EStatus::WRONG_CRC, CanE2E::check(profile, data, 8, state));
+}
+
+void test_crc_throughput()
+{
+    const CanE2EProfile profile = makeProfile(CanE2ECrc::SAE_J1850);
+    uint8_t data[8];
+    fillFrame(data, 1);
+
+    volatile uint8_t sink = 0;
+    const double table = nsPerFrame([&]
+    {
+        for (int i = 0; i < BENCH_FRAMES; i++)
+        {
+            data[2] = static_cast<uint8_t>(i);
+            sink = sink ^ CanE2E::calculateCrc(profile, data, 8);
+        }
+    });
+    const double bitwise = nsPerFrame([&]
+    {
+        for (int i = 0; i < BENCH_FRAMES; i++)
+        {
+            data[2] = static_cast<uint8_t>(i);
+            sink = sink ^ bitwiseCrc(profile, data, 8);
+        }
+    });
+    const double protect = nsPerFrame([&]
+    {
+        for (int i = 0; i < BENCH_FRAMES; i++)
+        {
+            data[2] = static_cast<uint8_t>(i);
+            (void)CanE2E::protect(profile, data, 8, static_cast<uint8_t>(i) & CAN_E2E_COUNTER_MASK);
+        }
+    });
+
+    char message[128];
+    snprintf(message, sizeof(message), "CRC8 per 8-byte frame: table %.1f ns, bitwise %.1f ns, protect %.1f ns",
+             table, bitwise, protect);
+    TEST_MESSAGE(message);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_table_matches_bitwise);
+    RUN_TEST(test_crc_check_values);
+    RUN_TEST(test_protected_frame_vectors);
+    RUN_TEST(test_profile_validation);
+    RUN_TEST(test_protect_and_check_sequence);
+    RUN_TEST(test_crc_throughput);
+    return UNITY_END();
+}